@@ -0,0 +1,43 @@
+#pragma once
+
+#include "LevelFormat.hpp"
+#include "render/AtlasBuilder.hpp"
+#include "render/Font.hpp"
+#include "render/TextureAtlas.hpp"
+#include "utils/AssetPack.hpp"
+#include <filesystem>
+#include <string>
+#include <vector>
+
+const int MENU_FONT_SIZE = 50;
+const int HUD_FONT_SIZE = 28;
+
+// Resolves a path below the assets directory, wherever the game was started
+// from: $JUNGLE_WAYS_ASSETS, next to the executable, one level above it (the
+// build directory) or the source tree the game was built from.
+std::string assetPath(const std::string& relative);
+// The pack produced by the packer tool lives next to the executable.
+std::string assetPackPath();
+
+// Sprite files, sorted so atlas region ids are stable.
+std::vector<std::filesystem::path> listSprites(const std::string& directory);
+// Level source files, sorted so their order in the game is stable.
+std::vector<std::filesystem::path> listLevels(const std::string& directory);
+// Sprites made in code rather than loaded from disk
+void addBuiltinSprites(render::AtlasBuilder& builder);
+// Rasterizes the menu and HUD sizes of the game font into the builder.
+bool rasterizeFonts(const std::string& fontFile, render::AtlasBuilder& builder, render::Font& menuFont, render::Font& hudFont);
+
+// Compiles every level source in the directory. Stops at the first broken
+// file, error then names it and the line.
+bool compileLevels(const std::string& directory, std::vector<CompiledLevel>& levels, std::string& error);
+
+// Stores a built atlas, with its mip chains, the fonts that live in it and
+// the compiled levels.
+bool writeAssetPack(const render::AtlasBuilder& builder, const render::Font& menuFont, const render::Font& hudFont, const std::vector<CompiledLevel>& levels, const std::string& packFile);
+// Uploads straight from the mapped pack. False if the pack does not hold a
+// usable atlas, the caller then builds one from the source files.
+bool loadAtlasPack(const AssetPack& pack, render::TextureAtlas& atlas, render::Font& menuFont, render::Font& hudFont);
+// Views of the levels in the pack, in pack order. False if it holds none or a
+// broken one, the caller then compiles the source files.
+bool loadLevelPack(const AssetPack& pack, std::vector<LevelData>& levels);
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "physics/Body.hpp"
+#include <cstdint>
+
+// Components of the game's entities. All plain data, stored per archetype by
+// ecs::Registry.
+
+// Copied from the physics body after every step, so systems that only read
+// positions never touch the bodies
+struct Transform {
+	physics::Vec2 position;
+	physics::Vec2 size;
+};
+
+// The body is owned by whoever created the entity
+struct PhysicsBody {
+	physics::Body* body;
+};
+
+enum class SPRITE_LAYER : uint8_t {
+	// Drawn into the cached static layer, must not move
+	STATIC,
+	DYNAMIC
+};
+
+struct Sprite {
+	int id;
+	SPRITE_LAYER layer;
+};
+
+// Bounces vertically between two heights
+struct MovingPlatform {
+	float minY;
+	float maxY;
+};
+
+// Ends the level when the player touches it
+struct Pickup {
+	int points;
+};
+
+struct Player {
+	float jumpVelocity;
+};
@@ -2,14 +2,38 @@
 
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_ttf.h>
+#include "Components.hpp"
+#include "Level.hpp"
 #include "Utils.hpp"
+#include "audio/Mixer.hpp"
+#include "ecs/Registry.hpp"
+#include "fx/ParticleSystem.hpp"
 #include "physics/Body.hpp"
 #include "physics/World.hpp"
+#include "utils/AllocationCounter.hpp"
+#include "utils/AssetPack.hpp"
+#include "utils/FramePacer.hpp"
+#include "utils/RollingStats.hpp"
+#include "utils/SpscQueue.hpp"
+#include "utils/StageTimer.hpp"
+#include "utils/ThreadPool.hpp"
+#include "utils/TripleBuffer.hpp"
+#include "render/Font.hpp"
+#include "render/RenderSnapshot.hpp"
+#include "render/SceneRenderer.hpp"
+#include "render/SpriteBatch.hpp"
+#include "render/TextureAtlas.hpp"
 
 #include <GL/gl.h>
 #include <GL/glu.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <future>
+#include <memory>
 #include <random>
 #include <ctime>
+#include <thread>
 
 enum struct TEXTURE {
 	branch = 0,
@@ -24,27 +48,84 @@ enum class GAME_STATE {
 	PLAYING
 };
 
+enum INPUT {
+	INPUT_LEFT = 1 << 0,
+	INPUT_RIGHT = 1 << 1,
+	INPUT_JUMP = 1 << 2
+};
+
+// A movement key going down or up, queued from the main thread to the
+// simulation thread
+struct InputEvent {
+	using clock = std::chrono::steady_clock;
+
+	clock::time_point time;
+	uint32_t input;
+	bool pressed;
+};
+
+// An input event and the played tick it was applied to. Recorded sessions
+// are text files: a "seed <n>" line with the random seed the levels were
+// built from, then one "<tick> <input bits> <1 pressed, 0 released>" per
+// line. The PGO trainer replays them on the same levels.
+struct InputRecord {
+	uint64_t tick;
+	uint32_t input;
+	bool pressed;
+};
+
+enum RESET_REQUEST {
+	RESET_NONE,
+	RESET_KEEP_SCORE,
+	RESET_SCORE
+};
+
 class Game {
 public:
 	Game(int width, int height);
 
+	void DrawRect(int x, int y, int width, int height, uint32_t color);
+	void FillRect(int x, int y, int width, int height, uint32_t color);
 	void handleCharacter();
 	void LevelDesign(bool resetCount);
-	GLuint LoadImageIntoTexture(const char* fileName);
-	void LoadTextures();
+	void BuildAtlas(StageTimer& timer);
+	int CollectPickups();
+	void DecodeSprites();
+	void LoadTextures(StageTimer& timer);
+	bool LoadLevels(StageTimer& timer);
 	void Logic();
 	void OnEvent(SDL_Event* event);
 	int OnExecute();
 	void OnExit();
 	bool OnInit();
 	void OnLoop();
+	// One gameplay tick, as OnLoop runs it while playing. Needs no window.
+	void PlayTick();
+	// Bumped whenever the static scenery changes
+	uint64_t LevelVersion() const;
 	void OnRender();
+	void PublishRenderState();
 	void RenderInGameMenu();
 	void RenderMainMenu();
 	void RenderMenuOption(const char* optionText, int x, int y, int width, int height, SDL_Color textColor);
 	void RenderOptionsMenu();
-	void RenderScene();
+	void RenderPerfOverlay(const render::RenderSnapshot& snapshot);
+	void RenderScene(const render::RenderSnapshot& snapshot);
 	void ResetGame(bool resetCount);
+	void ApplyInput();
+	void QueueInput(SDL_Scancode scancode, bool pressed);
+	void PushInput(uint32_t input, bool pressed);
+	void RecordInput(const std::string& fileName);
+	bool SaveInputRecording() const;
+	void ReportInputLatency(FILE* out) const;
+	void ReportAllocations(FILE* out) const;
+	void PlaySoundAt(audio::SOUND sound, float x);
+	void SimulationLoop();
+	void UpdateCamera();
+	void UpdateMovingPlatforms();
+	void UpdateParticleGeometry();
+	void UpdateEffects();
+	void UpdateTransforms();
 
 private:
 	int width;
@@ -54,35 +135,125 @@ private:
     const float MAIN_MENU_WIDTH_RATIO = 0.90f;
     const float MAIN_MENU_HEIGHT_RATIO = 0.90f;
 	const float tick = 1 / 60.0f;
-	bool isRunning;
-	GAME_STATE gameState;
+	// Screens covered by the cached static layer
+	static const int STATIC_LAYER_PAGES = 2;
+	// Budget for every live particle, and how fast leaves fall into view
+	static const int MAX_PARTICLES = 4096;
+	static const int LEAVES_PER_SECOND = 120;
+	std::atomic<bool> isRunning;
+	std::atomic<GAME_STATE> gameState;
 	GAME_STATE previousState;
 
 	int score;
+	// Simulation thread input state
+	uint32_t heldInput;
+	uint32_t pressedInput;
+	InputEvent::clock::time_point lastInputTime;
+	RollingStats inputToTick;
+	// Bumped whenever the static scenery changes
+	uint64_t levelVersion;
+	// Left edge of the view in level coordinates
+	float cameraX;
+	// Screen-sized page the static layer starts at
+	int streamedPage;
+
+	// Main thread to simulation thread
+	SpscQueue<InputEvent, 256> inputEvents;
+	int droppedInputs;
+	std::atomic<int> resetRequest;
+
+	// Simulation thread to render thread
+	TripleBuffer<render::RenderSnapshot> renderStates;
+	std::thread simulationThread;
+
+	// Simulation thread, played ticks and the input applied to them when
+	// recording
+	uint64_t playedTicks;
+	std::string recordingFile;
+	std::vector<InputRecord> recording;
+	// Simulation thread, time spent in the last tick before publishing
+	float tickMs;
+	// Simulation thread heap allocations. A steady tick is one played
+	// without a reset or chunks streaming, it should allocate nothing.
+	uint32_t tickAllocations;
+	uint32_t stepAllocations;
+	int steadyTicks;
+	int allocatingTicks;
+
+	// Render thread side of the input latency
+	InputEvent::clock::time_point presentedInputTime;
+	RollingStats inputToPresent;
+
+	// Performance overlay, toggled with F3. The text is refreshed a few
+	// times a second so it can be read, the graph every frame.
+	bool showPerfOverlay;
+	int perfTextFrames;
+	std::vector<std::string> perfText;
+	int lastDrawCalls;
+	int lastSprites;
+
+	// Render thread heap allocations. A steady frame draws the same static
+	// scenery as the one before it, with the overlay hidden.
+	uint64_t lastFrameVersion;
+	int steadyFrames;
+	int allocatingFrames;
+
+	FramePacer framePacer;
+	FramePacer tickPacer;
 
 	SDL_GLContext glContext;
-	TTF_Font* pFont;
-	SDL_Renderer* pRenderer;
 	SDL_Window* pWindow;
 	SDL_Rect startGameRect;
     SDL_Rect optionsRect;
     SDL_Rect exitRect;
 
-	const Uint8* keyboardStateArray = SDL_GetKeyboardState(NULL);
 
 	physics::World world;
+	Level level;
+	// Simulation thread visual effects, outside the physics world. The static
+	// scenery is handed to them as landing spots whenever it streams.
+	fx::ParticleSystem particles;
+	std::vector<fx::StaticBox> particleGeometry;
+	float leavesOwed;
+	bool playerGrounded;
+	// Views into the mapped pack, or into compiledLevels without one
+	std::vector<LevelData> levels;
+	std::vector<CompiledLevel> compiledLevels;
+	render::SpriteBatch spriteBatch;
+	render::TextureAtlas atlas;
+	render::SceneRenderer sceneRenderer;
+	// Opened in OnInit. Effects are played from the simulation thread, the
+	// options menu toggles ambience and music from the main thread.
+	audio::Mixer mixer;
+	render::Font menuFont;
+	render::Font hudFont;
+
+	ecs::Registry registry;
+	ecs::Entity player;
+	physics::Body playerBody;
+
+	int backgroundSprite;
+	int characterSprite;
+	int treeSprite;
+	int branchSprite;
+	int fruitSprite;
+	int vineSprite;
+	int whiteSprite;
+
+	struct DecodedSprite {
+		render::Image image;
+		bool loaded;
+		double ms;
+	};
+
+	struct PendingSprite {
+		std::string name;
+		std::future<DecodedSprite> decoded;
+	};
 
-	physics::Body* initialTree;
-	physics::Body* finalTree;
-	physics::Body* initialBranch;
-	physics::Body* finalBranch;
-	physics::Body* anotherBranch;
-	physics::Body* character;
-	physics::Body* fruit;
-
-	GLuint backgroundTextureId;
-    GLuint characterTextureId;
-    GLuint treeTextureId;
-    GLuint branchTextureId;
-    GLuint fruitTextureId;
+	// The mapped asset pack, kept for the levels in it, and at startup only
+	// the sprites being decoded while the window comes up
+	AssetPack assetPack;
+	std::unique_ptr<ThreadPool> assetWorkers;
+	std::vector<PendingSprite> pendingSprites;
 };
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "Components.hpp"
+#include "LevelFormat.hpp"
+#include "ecs/Registry.hpp"
+#include "physics/Body.hpp"
+#include "physics/Rope.hpp"
+#include "physics/World.hpp"
+#include "utils/Random.hpp"
+#include <vector>
+
+// One vertical strip of a level. Its entities and their bodies only exist
+// while the strip is near the camera.
+struct LevelChunk {
+	int index;
+	// Contiguous, added to the world in one go. Vines take a run of bodies,
+	// one per segment.
+	std::vector<physics::Body> bodies;
+	std::vector<physics::Rope> ropes;
+	std::vector<ecs::Entity> entities;
+};
+
+// A compiled level, many screens wide, streamed in chunk by chunk. Chunks
+// are built from the level data, the seed and their index alone, so any chunk
+// can be evicted and built again later in any order.
+class Level {
+public:
+	Level();
+
+	// The level is scaled from the screen it was laid out on to this one
+	void configure(int screenWidth, int screenHeight, int treeSprite, int branchSprite, int fruitSprite, int vineSprite);
+	// New level, which must outlive it. Nothing is loaded until the next
+	// stream(). Moving branches get faster with the score.
+	void reset(const LevelData& data, uint64_t seed, int score);
+
+	// Loads every chunk overlapping [x0, x1) into the world and the registry
+	// and evicts the rest. Returns whether anything was loaded or evicted.
+	bool stream(physics::World& world, ecs::Registry& registry, float x0, float x1);
+	void unload(physics::World& world, ecs::Registry& registry);
+
+	float getWidth() const;
+	// Center of a body of the given size standing on the spawn point
+	physics::Vec2 getSpawn(const physics::Vec2& size) const;
+	const std::vector<LevelChunk>& getChunks() const { return chunks; }
+
+private:
+	int chunkAt(float x) const;
+	bool isLoaded(int index) const;
+	void load(physics::World& world, ecs::Registry& registry, int index);
+	// Fills the chunk's bodies from next on, one per segment
+	void loadVine(ecs::Registry& registry, LevelChunk& chunk, const LevelBody& source, uint32_t index, int& next);
+	void evict(physics::World& world, ecs::Registry& registry, LevelChunk& chunk);
+	float movingSpeed(const LevelBody& source, uint32_t index) const;
+	int vineSegments(const LevelBody& source) const;
+
+	int screenWidth;
+	int screenHeight;
+	int treeSprite;
+	int branchSprite;
+	int fruitSprite;
+	int vineSprite;
+
+	const LevelData* data;
+	float scaleX;
+	float scaleY;
+	uint64_t seed;
+	int score;
+
+	std::vector<LevelChunk> chunks;
+};
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Compiled level, used in place straight out of the mapped asset pack.
+//
+// Layout: LevelHeader, then chunkCount LevelChunkRange records, then
+// bodyCount LevelBody records sorted by chunk, so streaming a chunk in is a
+// walk over one contiguous run. Coordinates are pixels of a screenWidth x
+// screenHeight screen and get scaled to the real one when loaded.
+enum class LEVEL_BODY : uint32_t {
+	TREE = 1,
+	BRANCH = 2,
+	MOVING_BRANCH = 3,	// Bounces vertically at a speed picked from [speedMin, speedMax]
+	FRUIT = 4,
+	VINE = 5	// Hangs from (x, y), width thick and height long
+};
+
+struct LevelHeader {
+	char magic[4];
+	uint32_t version;
+	float screenWidth;
+	float screenHeight;
+	float width;
+	float chunkWidth;
+	// Where the player's feet start
+	float spawnX;
+	float spawnY;
+	uint32_t chunkCount;
+	uint32_t bodyCount;
+};
+
+struct LevelChunkRange {
+	uint32_t firstBody;
+	uint32_t bodyCount;
+};
+
+// Center and full size
+struct LevelBody {
+	LEVEL_BODY kind;
+	float x, y;
+	float width, height;
+	float speedMin, speedMax;
+};
+
+// Compiles the text format, one directive per line, '#' starts a comment:
+//
+//   screen <width> <height>    reference screen the level was laid out on
+//   width <pixels>             level width
+//   chunk <pixels>             streaming chunk width
+//   spawn <x> <y>              player's feet
+//   tree <x>                   full height tree
+//   branch <x> <y>             fixed branch, centered
+//   moving <x> <y> <min> <max> moving branch, centered, speed range
+//   fruit <x> <y>              fruit resting with its bottom at y
+//   vine <x> <y> <length>      vine hanging from a point
+//
+// On failure, error says which line is wrong.
+bool compileLevel(const std::string& text, std::vector<uint8_t>& blob, std::string& error);
+
+struct CompiledLevel {
+	std::string name;
+	std::vector<uint8_t> blob;
+};
+
+// Read-only view of a compiled blob. The blob is validated once, after that
+// every access is a pointer into it.
+class LevelData {
+public:
+	static constexpr uint32_t VERSION = 2;
+
+	LevelData();
+
+	bool view(const uint8_t* data, size_t size);
+	bool isValid() const { return header != nullptr; }
+
+	const LevelHeader& getHeader() const { return *header; }
+	const LevelChunkRange* getChunks() const { return chunks; }
+	const LevelBody* getBodies() const { return bodies; }
+
+private:
+	const LevelHeader* header;
+	const LevelChunkRange* chunks;
+	const LevelBody* bodies;
+};
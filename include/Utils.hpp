@@ -1,9 +1,8 @@
 #pragma once
 
-#include <random>
 #include "physics/Body.hpp"
+#include "utils/Random.hpp"
 
 float randomFloat(float min, float max);
 int randomInt(int min, int max);
 float newVel(int x);
-void loadTextureIntoBody(physics::Body& body, GLuint textureId);
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "MusicStream.hpp"
+#include "Sound.hpp"
+#include "../utils/Random.hpp"
+#include "../utils/SpscQueue.hpp"
+#include <SDL2/SDL.h>
+#include <atomic>
+#include <memory>
+#include <string>
+
+namespace audio {
+
+struct AudioCommand {
+	SOUND sound;
+	float gain;
+	// -1 is all left, 1 all right
+	float pan;
+};
+
+// Mixes effects, the jungle ambience and streamed music in SDL's audio
+// callback. The callback never locks or allocates: effects are synthesized
+// before the device starts, requests arrive through a lock-free queue and
+// music through the stream's ring, and the ambience is generated on the
+// spot. With a 256 frame buffer a request is heard within about 5ms.
+class Mixer {
+public:
+	enum { VOICES = 16, BUFFER_FRAMES = 256 };
+
+	Mixer();
+	~Mixer();
+
+	Mixer(const Mixer&) = delete;
+	Mixer& operator=(const Mixer&) = delete;
+
+	// Needs SDL's audio subsystem. False without an audio device, in which
+	// case the game runs silent. The music is optional.
+	bool open(const std::string& musicFile);
+	void close();
+	bool isOpen() const { return device != 0; }
+
+	// Simulation thread only, the queue has a single producer. Requests
+	// past a full queue are dropped.
+	void play(SOUND sound, float gain = 1.0f, float pan = 0.0f);
+
+	// Any thread, faded in and out by the mixer
+	void setAmbient(bool on) { ambientOn = on; }
+	bool isAmbientOn() const { return ambientOn; }
+	void setMusic(bool on) { musicOn = on; }
+	bool isMusicOn() const { return musicOn; }
+
+	// Callbacks the music ring ran dry in
+	int getUnderruns() const { return underruns; }
+
+private:
+	struct Voice {
+		const Sound* sound;
+		size_t position;
+		float left, right;
+	};
+
+	static void callback(void* userdata, Uint8* stream, int length);
+	void mix(float* out, int frames);
+	void startVoice(const AudioCommand& command);
+	void mixAmbient(float* out, int frames);
+	void mixMusic(float* out, int frames);
+
+	SDL_AudioDeviceID device;
+	int sampleRate;
+	Sound sounds[static_cast<int>(SOUND::COUNT)];
+	SpscQueue<AudioCommand, 64> commands;
+	// Big enough to keep off the stack
+	std::unique_ptr<MusicStream> music;
+
+	std::atomic<bool> ambientOn;
+	std::atomic<bool> musicOn;
+	std::atomic<int> underruns;
+
+	// Audio thread only
+	Voice voices[VOICES];
+	float ambientGain;
+	float musicGain;
+	Pcg32 noise;
+	float wind;
+	float gustPhase;
+	// Bird calls: a few short rising notes, then a pause
+	int untilCall;
+	int notesLeft;
+	int notePosition;
+	float notePhase;
+	float noteFrequency;
+	float notePan;
+};
+
+}
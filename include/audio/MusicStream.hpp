@@ -0,0 +1,49 @@
+#pragma once
+
+#include "../utils/SpscQueue.hpp"
+#include <atomic>
+#include <string>
+#include <thread>
+
+namespace audio {
+
+struct StereoFrame {
+	float left;
+	float right;
+};
+
+// Music streamed from a PCM WAV file. A background thread decodes it a
+// block at a time, converts it to stereo float at the device rate and keeps
+// a ring of about two thirds of a second filled; the mixer only ever pops
+// ready frames off the ring. The track loops.
+class MusicStream {
+public:
+	enum { RING_FRAMES = 1 << 15 };
+
+	MusicStream();
+	~MusicStream();
+
+	MusicStream(const MusicStream&) = delete;
+	MusicStream& operator=(const MusicStream&) = delete;
+
+	// False if the file can't be read or isn't 8 or 16-bit PCM
+	bool start(const std::string& fileName, int sampleRate);
+	void stop();
+	// False once the decoder has given up on the file
+	bool isPlaying() const { return playing; }
+
+	// Audio thread
+	bool pop(StereoFrame& frame) { return ring.pop(frame); }
+
+private:
+	// Clears playing when the decoder stops, whatever the reason
+	void decode(std::string fileName, int sampleRate);
+	void decodeFile(const std::string& fileName, int sampleRate);
+
+	SpscQueue<StereoFrame, RING_FRAMES> ring;
+	std::atomic<bool> running;
+	std::atomic<bool> playing;
+	std::thread decoder;
+};
+
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <vector>
+
+namespace audio {
+
+enum class SOUND {
+	JUMP,
+	LAND,
+	PICKUP,
+	COUNT
+};
+
+// Mono samples in [-1, 1] at the device rate, played from memory
+struct Sound {
+	std::vector<float> samples;
+};
+
+// The effects are short enough to synthesize at startup instead of shipping
+// them, and come out at whatever rate the device runs at
+Sound synthesize(SOUND sound, int sampleRate);
+
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "Entity.hpp"
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace ecs {
+
+struct ComponentInfo {
+	int id;
+	size_t size;
+	size_t alignment;
+};
+
+// Storage for every entity with exactly one set of components. Entities live
+// in fixed-size chunks, each holding one contiguous array per component, so
+// a system walks plain arrays. Rows are kept dense: removing one moves the
+// last row of the last chunk into the hole.
+class Archetype {
+public:
+	enum { CHUNK_BYTES = 16 * 1024 };
+
+	struct Chunk {
+		std::unique_ptr<uint8_t[]> data;
+		int count;
+	};
+
+	Archetype(Signature signature, std::vector<ComponentInfo> components);
+
+	Signature getSignature() const { return signature; }
+	int getCapacity() const { return capacity; }
+	std::vector<Chunk>& getChunks() { return chunks; }
+
+	// Appends a zeroed row for the entity
+	void add(Entity entity, int& chunk, int& row);
+	// Returns the entity that was moved into the row, or NULL_ENTITY if the
+	// removed row was the last one
+	Entity remove(int chunk, int row);
+
+	void* column(Chunk& chunk, int componentId) const { return chunk.data.get() + offsets[componentId]; }
+	Entity* entities(Chunk& chunk) const { return reinterpret_cast<Entity*>(chunk.data.get()); }
+
+	template <typename T>
+	T* column(Chunk& chunk, int componentId) const { return static_cast<T*>(column(chunk, componentId)); }
+
+private:
+	Signature signature;
+	std::vector<ComponentInfo> components;
+	int capacity;
+	// Byte offset of each component's array inside a chunk, by component id
+	size_t offsets[MAX_COMPONENTS];
+
+	std::vector<Chunk> chunks;
+	// The last chunk to empty, reused before allocating a new one
+	std::unique_ptr<uint8_t[]> spare;
+};
+
+}
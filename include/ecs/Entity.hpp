@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstdint>
+
+namespace ecs {
+
+// Index into the registry plus the generation of that index, so a handle to
+// a destroyed entity never refers to whatever reuses its slot.
+struct Entity {
+	uint32_t index;
+	uint32_t generation;
+
+	bool operator==(const Entity& other) const { return index == other.index && generation == other.generation; }
+	bool operator!=(const Entity& other) const { return !(*this == other); }
+};
+
+const Entity NULL_ENTITY{ UINT32_MAX, 0 };
+
+// One bit per component type
+typedef uint32_t Signature;
+
+enum { MAX_COMPONENTS = 32 };
+
+}
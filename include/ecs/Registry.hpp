@@ -0,0 +1,151 @@
+#pragma once
+
+#include "Archetype.hpp"
+#include "Entity.hpp"
+#include <cassert>
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace ecs {
+
+// Component type ids, handed out on first use
+int nextComponentId();
+
+template <typename T>
+int componentId() {
+	static const int id = nextComponentId();
+	return id;
+}
+
+// Owns every entity and its components. Components are plain data, copied
+// around with memcpy, and looked up by type.
+//
+// Creating or destroying entities invalidates component references and must
+// not happen inside each().
+class Registry {
+public:
+	Registry() {}
+
+	Registry(const Registry&) = delete;
+	Registry& operator=(const Registry&) = delete;
+
+	template <typename... Cs>
+	Entity create(const Cs&... components) {
+		static_assert(sizeof...(Cs) > 0, "An entity needs at least one component");
+
+		Signature signature = signatureOf<Cs...>();
+		Archetype* found = findArchetype(signature);
+		Archetype& archetype = found ? *found : addArchetype(signature, { info<Cs>()... });
+		Entity entity = allocate();
+		Record& record = records[entity.index];
+		record.archetype = &archetype;
+		archetype.add(entity, record.chunk, record.row);
+
+		Archetype::Chunk& chunk = archetype.getChunks()[record.chunk];
+		int row = record.row;
+		(void)std::initializer_list<int>{ (archetype.template column<Cs>(chunk, componentId<Cs>())[row] = components, 0)... };
+		return entity;
+	}
+
+	void destroy(Entity entity);
+	void clear();
+
+	bool isAlive(Entity entity) const {
+		return entity.index < records.size() && records[entity.index].generation == entity.generation && records[entity.index].archetype;
+	}
+	size_t size() const { return records.size() - freeIndices.size(); }
+
+	template <typename T>
+	bool has(Entity entity) const {
+		return isAlive(entity) && (records[entity.index].archetype->getSignature() & bit<T>());
+	}
+
+	template <typename T>
+	T& get(Entity entity) {
+		assert(has<T>(entity));
+		Record& record = records[entity.index];
+		return record.archetype->template column<T>(record.archetype->getChunks()[record.chunk], componentId<T>())[record.row];
+	}
+
+	// Calls fn(Cs&...) for every entity that has all of Cs, one dense array
+	// per component and chunk
+	template <typename... Cs, typename F>
+	void each(F&& fn) {
+		Signature mask = signatureOf<Cs...>();
+		for (auto& archetype : archetypes) {
+			if ((archetype->getSignature() & mask) != mask) {
+				continue;
+			}
+			for (auto& chunk : archetype->getChunks()) {
+				std::tuple<Cs*...> columns(archetype->template column<Cs>(chunk, componentId<Cs>())...);
+				for (int i = 0; i < chunk.count; ++i) {
+					fn(std::get<Cs*>(columns)[i]...);
+				}
+			}
+		}
+	}
+
+	// Same, with the entity as the first argument
+	template <typename... Cs, typename F>
+	void eachEntity(F&& fn) {
+		Signature mask = signatureOf<Cs...>();
+		for (auto& archetype : archetypes) {
+			if ((archetype->getSignature() & mask) != mask) {
+				continue;
+			}
+			for (auto& chunk : archetype->getChunks()) {
+				Entity* entities = archetype->entities(chunk);
+				std::tuple<Cs*...> columns(archetype->template column<Cs>(chunk, componentId<Cs>())...);
+				for (int i = 0; i < chunk.count; ++i) {
+					fn(entities[i], std::get<Cs*>(columns)[i]...);
+				}
+			}
+		}
+	}
+
+private:
+	struct Record {
+		Archetype* archetype;
+		int chunk;
+		int row;
+		uint32_t generation;
+	};
+
+	template <typename T>
+	static ComponentInfo info() {
+		static_assert(std::is_trivially_copyable<T>::value, "Components must be plain data");
+		static_assert(alignof(T) <= alignof(std::max_align_t), "Component alignment is not supported");
+		return ComponentInfo{ componentId<T>(), sizeof(T), alignof(T) };
+	}
+
+	template <typename T>
+	static Signature bit() {
+		int id = componentId<T>();
+		assert(id < MAX_COMPONENTS);
+		return Signature(1) << id;
+	}
+
+	template <typename... Cs>
+	static Signature signatureOf() {
+		Signature signature = 0;
+		(void)std::initializer_list<int>{ (signature |= bit<Cs>(), 0)... };
+		return signature;
+	}
+
+	Entity allocate();
+	Archetype* findArchetype(Signature signature) const;
+	Archetype& addArchetype(Signature signature, std::vector<ComponentInfo> components);
+
+	std::vector<std::unique_ptr<Archetype>> archetypes;
+	std::unordered_map<Signature, Archetype*> archetypesBySignature;
+
+	std::vector<Record> records;
+	std::vector<uint32_t> freeIndices;
+};
+
+}
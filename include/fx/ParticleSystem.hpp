@@ -0,0 +1,78 @@
+#pragma once
+
+#include "../render/RenderSnapshot.hpp"
+#include "../utils/Random.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace fx {
+
+enum class EFFECT : uint8_t {
+	// Drifts down from the canopy and settles on branches
+	LEAF,
+	// Kicked up where the player lands
+	DUST,
+	// Burst for a collected fruit
+	SPARK,
+	COUNT
+};
+
+// Scenery particles can land on, from above only
+struct StaticBox {
+	float x0, y0;
+	float x1, y1;
+};
+
+// Purely visual particles, kept out of physics::World altogether. Storage is
+// one array per field, padded to a multiple of four, so update() runs four
+// particles per instruction and only touches the fields it needs. Everything
+// is allocated up front: the capacity is the budget, and particles emitted
+// past it are dropped.
+class ParticleSystem {
+public:
+	explicit ParticleSystem(int capacity = 4096);
+
+	// Spawns count particles of the effect around (x, y), as many as fit.
+	// Returns how many did.
+	int emit(EFFECT effect, float x, float y, int count, Pcg32& random);
+	void clear() { count = 0; }
+
+	// Indexes the boxes by column, replacing the previous ones
+	void setStaticGeometry(const std::vector<StaticBox>& boxes);
+
+	void update(float dt);
+
+	// Appends the live particles overlapping [x0, x1)
+	void publish(std::vector<render::ParticleInstance>& out, int spriteId, float x0, float x1) const;
+
+	int getCount() const { return count; }
+	int getCapacity() const { return capacity; }
+
+private:
+	void integrate(float dt);
+	void land(float dt);
+	void expire();
+	void remove(int i);
+
+	int capacity;
+	int count;
+
+	std::vector<float> x, y;
+	std::vector<float> vx, vy;
+	std::vector<float> gravity;
+	std::vector<float> drag;
+	std::vector<float> age;
+	std::vector<float> life;
+	std::vector<float> size;
+	std::vector<uint32_t> color;
+	std::vector<uint8_t> collides;
+
+	// Uniform columns over the boxes, each a run of cellBoxes
+	float cellOrigin;
+	float cellWidth;
+	std::vector<StaticBox> boxes;
+	std::vector<int> cellStart;
+	std::vector<int> cellBoxes;
+};
+
+}
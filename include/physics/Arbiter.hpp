@@ -1,7 +1,6 @@
 #pragma once
 
 #include "Body.hpp"
-#include "World.hpp"
 
 namespace physics {
 
@@ -49,10 +48,30 @@ struct Arbiter {
 
 	float friction;
 
+	// Two point manifolds solve both normal impulses at once as a 2x2 LCP,
+	// unless the pair's K matrix is too close to singular
+	bool blockSolve;
+	Mat22 K;
+	Mat22 normalMass;
+
 	Arbiter(Body* body1, Body* body2);
 	void update(Contact* contacts, int numContacts);
 	void preStep(float invDt);
 	void applyImpulse();
+	// Position correction when World::splitImpulse is on
+	void applyBiasImpulse();
+
+private:
+	float velocityBias(const Contact* c) const;
+	// Returns the impulse applied
+	float applyNormalImpulse(Contact* c);
+	void applyBlockNormalImpulse();
+	// dPn is the normal impulse just applied, friction's limit when
+	// impulses aren't accumulated
+	void applyTangentImpulse(Contact* c, float dPn);
+	void applyImpulse(Contact* c, const Vec2& P);
+	bool solveBlock(const Vec2& vn0, const Vec2& a, Vec2& x) const;
+	void applyBiasImpulse(Contact* c, const Vec2& P);
 };
 
 extern int collide(Contact* contacts, Body* body1, Body* body2);
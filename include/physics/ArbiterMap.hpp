@@ -0,0 +1,45 @@
+#pragma once
+
+#include "Arbiter.hpp"
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace physics {
+
+// The world's arbiters, kept sorted by key in one array. There are only a
+// handful of touching pairs, so a lookup is a short binary search and an
+// insert or erase shifts a few entries. Once the array has grown to the
+// busiest step, nothing allocates any more, unlike the nodes of a std::map.
+class ArbiterMap {
+public:
+	typedef std::pair<ArbiterKey, Arbiter> value_type;
+	typedef std::vector<value_type>::iterator iterator;
+	typedef std::vector<value_type>::const_iterator const_iterator;
+
+	iterator begin() { return entries.begin(); }
+	iterator end() { return entries.end(); }
+	const_iterator begin() const { return entries.begin(); }
+	const_iterator end() const { return entries.end(); }
+
+	iterator find(const ArbiterKey& key);
+	size_t count(const ArbiterKey& key) const;
+	// The key must not be present yet
+	void insert(const value_type& entry);
+	iterator erase(iterator position);
+	void erase(const ArbiterKey& key);
+
+	size_t size() const { return entries.size(); }
+	bool empty() const { return entries.empty(); }
+	// Keeps the capacity
+	void clear() { entries.clear(); }
+	void reserve(size_t capacity) { entries.reserve(capacity); }
+
+private:
+	iterator lowerBound(const ArbiterKey& key);
+	const_iterator lowerBound(const ArbiterKey& key) const;
+
+	std::vector<value_type> entries;
+};
+
+}
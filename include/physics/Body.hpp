@@ -1,16 +1,26 @@
 #pragma once
 
-#include <GL/gl.h>
-#include <FreeImage.h>
 #include "Math.hpp"
-#include <iostream>
-#include <filesystem>
+#include <cstdint>
 
 namespace physics {
 
+// Collision shape, fitted into the body's width. Circles and capsules take
+// their radius from width.x; a capsule stands upright in the body frame,
+// its caps touching the top and bottom of the bounds.
+enum class SHAPE : uint8_t {
+	BOX,
+	CIRCLE,
+	CAPSULE,
+	COUNT
+};
+
 struct Body {
 	int id;
-	GLuint textureId;
+	// Order the body was added to the world in, never reused. Pairs are
+	// kept in this order, not by address, so a step doesn't depend on where
+	// the bodies happen to live in memory.
+	uint32_t serial;
 
 	Vec2 position;
 	Vec2 velocity;
@@ -19,18 +29,26 @@ struct Body {
 	Vec2 terminalVelocity;
 	float rotation;
 	float angularVelocity;
+	// Pseudo velocity pushing the body out of penetration. It moves the body
+	// for one step only and never becomes momentum.
+	Vec2 biasVelocity;
+	float biasAngularVelocity;
 	float torque;
 	float friction;
 	float mass, invMass;
 	float I, invI;
+	SHAPE shape;
+	// Bodies sharing a non-zero group never collide, like the links of a rope
+	int group;
+	// Contacts and joints never turn the body, like the upright character.
+	// Set before set() or setMass().
+	bool fixedRotation;
 	bool canJump;
 
 	Body();
-	void set(const Vec2& w, float m);
+	void set(const Vec2& w, float m, SHAPE s = SHAPE::BOX);
 	void addForce(const Vec2& f);
-	void draw() const;
 	void setMass(float m);
-	void applyTexture(GLuint textureId);
 };
 
 }
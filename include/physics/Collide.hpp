@@ -32,6 +32,18 @@ struct ClipVertex {
 void flip(FeaturePair& featurePair);
 int clipSegmentToLine(ClipVertex vOut[2], ClipVertex vIn[2], const Vec2& normal, float offset, char clipEdge);
 void computeIncidentEdge(ClipVertex c[2], const Vec2& h, const Vec2& pos, const Mat22& Rot, const Vec2& normal);
+
+// Manifold generators for each pair of shapes, A's shape first in SHAPE
+// order. The normal points from A to B. Feature pairs only depend on which
+// parts of the shapes touch, so contacts persist for warm starting.
+int collideBoxes(Contact* contacts, Body* bodyA, Body* bodyB);
+int collideBoxCircle(Contact* contacts, Body* box, Body* circle);
+int collideBoxCapsule(Contact* contacts, Body* box, Body* capsule);
+int collideCircles(Contact* contacts, Body* bodyA, Body* bodyB);
+int collideCircleCapsule(Contact* contacts, Body* circle, Body* capsule);
+int collideCapsules(Contact* contacts, Body* bodyA, Body* bodyB);
+
+// Picks the generator for the pair of shapes
 int collide(Contact* contacts, Body* bodyA, Body* bodyB);
 
 }
@@ -22,6 +22,8 @@ struct Joint {
 
 	void preStep(float invDt);
 	void applyImpulse();
+	// Position correction when World::splitImpulse is on
+	void applyBiasImpulse();
 	void set(Body* body1, Body* body2, const Vec2& anchor);
 	void draw();
 };
@@ -26,16 +26,20 @@ struct Vec2 {
 		x *= a; y *= a;
 	}
 
+	// sqrtf is correctly rounded by IEEE 754, so it is the same everywhere
 	float length() const {
 		return sqrtf(x * x + y * y);
 	}
 };
 
+void sinCos(float angle, float& s, float& c);
+
 struct Mat22 {
 	Vec2 col1, col2;
 	Mat22() {}
 	Mat22(float angle) {
-		float c = cosf(angle), s = sinf(angle);
+		float c, s;
+		sinCos(angle, s, c);
 		col1.x = c; col2.x = -s;
 		col1.y = s; col2.y = c;
 	}
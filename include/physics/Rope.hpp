@@ -0,0 +1,51 @@
+#pragma once
+
+#include "Body.hpp"
+#include "Math.hpp"
+#include <vector>
+
+namespace physics {
+
+// One point joint of a rope. A null body1 pins the rope to the world at
+// localAnchor1, which is then in world coordinates.
+struct RopeLink {
+	Body* body1;
+	Body* body2;
+	Vec2 localAnchor1, localAnchor2;
+	Vec2 r1, r2;
+	Vec2 bias;
+	Vec2 p;
+
+	// Diagonal block, block coupling it to the next link, and their block LDL^T
+	// factors
+	Mat22 K;
+	Mat22 B;
+	Mat22 L;
+	Mat22 invD;
+	Vec2 rhs;
+};
+
+// Chain of bodies hanging from each other by point joints. Solving the
+// joints one at a time like Joint does needs more iterations the longer the
+// chain, so links are solved together instead: the joints of a chain only
+// couple to their neighbours, a block tridiagonal system that block
+// elimination solves exactly in one pass. A rope stays stiff whatever
+// World::iterations is, at O(links) per solve.
+struct Rope {
+	std::vector<RopeLink> links;
+	float biasFactor;
+
+	Rope();
+
+	// Links must come in order, each body2 being the next link's body1
+	void pin(Body* body, const Vec2& anchor);
+	void link(Body* body1, Body* body2, const Vec2& anchor);
+	void clear() { links.clear(); }
+
+	void preStep(float invDt);
+	void applyImpulse();
+	// Position correction when World::splitImpulse is on
+	void applyBiasImpulse();
+};
+
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+namespace physics {
+
+// Where the last World::step spent its time, and how much it had to do
+struct StepStats {
+	float broadPhaseMs;
+	float preStepMs;
+	float solveMs;
+	// Velocity and position integration together
+	float integrateMs;
+
+	int bodies;
+	int arbiters;
+	int contacts;
+
+	StepStats() : broadPhaseMs(0.0f), preStepMs(0.0f), solveMs(0.0f), integrateMs(0.0f), bodies(0), arbiters(0), contacts(0) {}
+
+	float totalMs() const { return broadPhaseMs + preStepMs + solveMs + integrateMs; }
+};
+
+}
@@ -1,9 +1,11 @@
 #pragma once
 
 #include <vector>
-#include <map>
 #include "Arbiter.hpp"
+#include "ArbiterMap.hpp"
 #include "Joint.hpp"
+#include "Rope.hpp"
+#include "StepStats.hpp"
 #include <iostream>
 
 namespace physics {
@@ -15,18 +17,31 @@ struct Joint;
 struct World {
 	std::vector<Body*> bodies;
 	std::vector<Joint*> joints;
-	std::map<ArbiterKey, Arbiter> arbiters;
+	std::vector<Rope*> ropes;
+	ArbiterMap arbiters;
+	// Filled in by every step()
+	StepStats stats;
 
 	Vec2 gravity;
 	int iterations;
 	static bool accumulateImpulses;
 	static bool warmStarting;
 	static bool positionCorrection;
+	static bool blockSolver;
+	static bool splitImpulse;
+	uint32_t nextSerial;
 
 	World();
-	World(Vec2 gravity, int iterations) : gravity(gravity), iterations(iterations) {}
+	World(Vec2 gravity, int iterations) : gravity(gravity), iterations(iterations), nextSerial(0) {}
 	void add(Body* body);
+	// A contiguous run of bodies, with a single reallocation at most
+	void add(Body* first, int count);
 	void add(Joint* joint);
+	void add(Rope* rope);
+	// Drops the body and every arbiter it takes part in. The last body takes
+	// its id, so ids stay dense.
+	void remove(Body* body);
+	void remove(Rope* rope);
 	void clear();
 	void step(float dt);
 	void broadPhase();
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "Image.hpp"
+#include "SpriteBatch.hpp"
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace render {
+
+struct AtlasRegion {
+	int page;
+	int x, y;
+	int width, height;
+	UVRect uv;
+};
+
+// Packs any number of images into as few pages as possible. Pure CPU work,
+// so it runs at startup as well as in offline tools.
+class AtlasBuilder {
+public:
+	explicit AtlasBuilder(int maxPageSize = 2048, int padding = 4);
+
+	// Returns the region id the image will be found under after build().
+	int add(const std::string& name, Image image);
+	// Shelf-packs every added image, tallest first, and releases the source
+	// pixels. Images larger than a page are rejected and get an empty region.
+	void build();
+
+	int find(const std::string& name) const;
+
+	const std::vector<Image>& getPages() const { return pages; }
+	const std::vector<AtlasRegion>& getRegions() const { return regions; }
+	const std::vector<std::string>& getNames() const { return names; }
+
+private:
+	void blit(Image& page, const Image& image, int x, int y);
+
+	int maxPageSize;
+	int padding;
+
+	std::vector<Image> images;
+	std::vector<std::string> names;
+	std::unordered_map<std::string, int> ids;
+
+	std::vector<Image> pages;
+	std::vector<AtlasRegion> regions;
+};
+
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "AtlasBuilder.hpp"
+#include "SpriteBatch.hpp"
+#include "TextureAtlas.hpp"
+#include <SDL2/SDL_ttf.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace render {
+
+struct GlyphQuad {
+	int region;
+	float x0, y0;
+	float x1, y1;
+};
+
+// Glyph quads of a string, relative to its top-left corner.
+struct TextLayout {
+	std::vector<GlyphQuad> quads;
+	float width;
+	float height;
+};
+
+// Text drawn from glyphs that were rasterized once into the sprite atlas.
+// Each TTF size is its own Font. Laid-out strings are cached, so drawing the
+// same string again costs only the quads.
+class Font {
+public:
+	Font();
+
+	// Adds the printable ASCII glyphs of `font` to the builder, named
+	// "<name>/<code>". The TTF font is not needed afterwards.
+	void rasterize(TTF_Font* font, const std::string& name, AtlasBuilder& builder);
+
+	// Glyph table as raw bytes, so a rasterized font can be stored in an
+	// asset pack next to the atlas it refers to.
+	std::vector<uint8_t> saveMetrics() const;
+	bool loadMetrics(const uint8_t* data, size_t size);
+
+	const TextLayout& layout(const std::string& text);
+	void draw(SpriteBatch& batch, const TextureAtlas& atlas, const std::string& text, float x, float y, uint32_t color);
+
+	float getLineHeight() const { return metrics.lineHeight; }
+
+private:
+	enum { FIRST_CHAR = 32, LAST_CHAR = 126, CHAR_COUNT = LAST_CHAR - FIRST_CHAR + 1 };
+	// Laid-out strings kept before the cache starts over
+	enum { MAX_CACHED = 256 };
+
+	struct Glyph {
+		int region;
+		int width, height;
+		int advance;
+	};
+
+	struct Metrics {
+		Glyph glyphs[CHAR_COUNT];
+		signed char kerning[CHAR_COUNT][CHAR_COUNT];
+		float lineHeight;
+	};
+
+	Metrics metrics;
+
+	std::unordered_map<std::string, TextLayout> cache;
+};
+
+}
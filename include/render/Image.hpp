@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace render {
+
+// 32-bit BGRA pixels, rows stored top to bottom.
+struct Image {
+	int width;
+	int height;
+	std::vector<uint8_t> pixels;
+
+	Image() : width(0), height(0) {}
+	Image(int width, int height) : width(width), height(height), pixels(static_cast<size_t>(width) * height * 4, 0) {}
+};
+
+// Decodes any format FreeImage understands. Returns false if the file could
+// not be read.
+bool loadImage(const char* fileName, Image& image);
+
+// Box-filtered mip chain of `base`, level 0 (a copy of base) included.
+std::vector<Image> buildMipChain(const Image& base, int maxLevels);
+
+}
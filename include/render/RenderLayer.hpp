@@ -0,0 +1,34 @@
+#pragma once
+
+#include <GL/gl.h>
+
+namespace render {
+
+// Offscreen color target. Content that rarely changes is drawn into it once
+// and composited every frame as a single textured quad.
+class RenderLayer {
+public:
+	RenderLayer();
+
+	// All of these need a current GL context.
+	bool init(int width, int height);
+	void destroy();
+
+	// Redirects drawing into the layer, clearing it first
+	void begin();
+	void end();
+
+	GLuint getTexture() const { return texture; }
+
+	// Texture coordinates putting the layer upright on a y-down screen
+	static constexpr float U0 = 0.0f, V0 = 1.0f, U1 = 1.0f, V1 = 0.0f;
+
+private:
+	GLuint framebuffer;
+	GLuint texture;
+	int width;
+	int height;
+	GLint previousViewport[4];
+};
+
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "../physics/StepStats.hpp"
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace render {
+
+struct SpriteInstance {
+	int spriteId;
+	float x0, y0;
+	float x1, y1;
+};
+
+// Centered quad, tinted
+struct ParticleInstance {
+	int spriteId;
+	float x, y;
+	float size;
+	uint32_t color;
+};
+
+// Everything the render thread needs to draw one simulation tick. Produced
+// by the simulation thread and never modified once published.
+struct RenderSnapshot {
+	std::vector<SpriteInstance> sprites;
+	// Scenery that only changes together with staticVersion, so the render
+	// thread can cache it
+	std::vector<SpriteInstance> staticSprites;
+	// Drawn over the sprites
+	std::vector<ParticleInstance> particles;
+	uint64_t staticVersion;
+	// Level coordinates of the static layer's and the view's left edges
+	float staticOriginX;
+	float cameraX;
+	// Most recent key press the simulation had applied by this tick
+	std::chrono::steady_clock::time_point inputTime;
+	int score;
+	// Simulation ticks played so far
+	uint64_t tick;
+	// For the performance overlay
+	physics::StepStats step;
+	float tickMs;
+	// Heap allocations of the previous tick, and of its physics step
+	uint32_t tickAllocations;
+	uint32_t stepAllocations;
+	int liveParticles;
+
+	RenderSnapshot() : staticVersion(0), staticOriginX(0.0f), cameraX(0.0f), score(0), tick(0), tickMs(0.0f), tickAllocations(0), stepAllocations(0), liveParticles(0) {}
+};
+
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "RenderLayer.hpp"
+#include "RenderSnapshot.hpp"
+#include "SpriteBatch.hpp"
+#include "TextureAtlas.hpp"
+#include <vector>
+
+namespace render {
+
+// Draws the world part of a RenderSnapshot: the tiled background and static
+// sprites, cached in an offscreen layer, then the moving sprites. Used by the
+// game and by the render benchmark alike.
+class SceneRenderer {
+public:
+	SceneRenderer(SpriteBatch& batch, const TextureAtlas& atlas);
+
+	// All of these need a current GL context. The static layer covers
+	// layerPages screens of level space.
+	void init(int width, int height, int layerPages);
+	void destroy();
+
+	void setBackground(int spriteId) { backgroundSprite = spriteId; }
+	// False if the static layer could not be created; scenes are then drawn
+	// in full every frame.
+	bool isLayerReady() const { return layerReady; }
+
+	// Re-renders the static layer if the snapshot's static content changed,
+	// and returns whether it did. Must be called outside of batch.begin() /
+	// end().
+	bool prepare(const RenderSnapshot& snapshot);
+	// Adds the scene to the open batch, in screen space
+	void draw(const RenderSnapshot& snapshot);
+
+private:
+	void drawSprites(const std::vector<SpriteInstance>& sprites, float offsetX);
+	void drawParticles(const std::vector<ParticleInstance>& particles, float offsetX);
+	void drawStatic(const RenderSnapshot& snapshot, float x0, float x1, float offsetX);
+
+	SpriteBatch& batch;
+	const TextureAtlas& atlas;
+
+	RenderLayer layer;
+	bool layerReady;
+	uint64_t layerVersion;
+
+	int width;
+	int height;
+	int layerPages;
+	int backgroundSprite;
+};
+
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <GL/gl.h>
+#include <cstdint>
+#include <vector>
+
+namespace render {
+
+// Texture coordinates of the top-left (u0, v0) and bottom-right (u1, v1)
+// corners of a sprite.
+struct UVRect {
+	float u0, v0;
+	float u1, v1;
+};
+
+struct SpriteVertex {
+	float x, y;
+	float u, v;
+	uint32_t color;
+};
+
+// Packs a color into the byte order GL reads for GL_UNSIGNED_BYTE colors.
+inline uint32_t packColor(uint8_t r, uint8_t g, uint8_t b, uint8_t a = 255) {
+	return static_cast<uint32_t>(r) | (static_cast<uint32_t>(g) << 8) | (static_cast<uint32_t>(b) << 16) | (static_cast<uint32_t>(a) << 24);
+}
+
+const uint32_t WHITE = 0xFFFFFFFFu;
+
+// Collects textured quads for a whole frame into one streamed vertex buffer
+// and draws every run of quads sharing a texture with a single call.
+// Submission order is kept, so later sprites are drawn on top.
+class SpriteBatch {
+public:
+	explicit SpriteBatch(int maxSprites = 4096);
+	~SpriteBatch();
+
+	// Both need a current GL context.
+	void init();
+	void destroy();
+
+	void begin();
+	void draw(GLuint texture, float x0, float y0, float x1, float y1, const UVRect& uv, uint32_t color = WHITE);
+	void end();
+
+	int getDrawCalls() const { return drawCalls; }
+	int getTextureBinds() const { return textureBinds; }
+	int getSpriteCount() const { return spriteCount; }
+
+private:
+	struct Run {
+		GLuint texture;
+		int first;
+		int count;
+	};
+
+	void flush();
+
+	int maxSprites;
+	std::vector<SpriteVertex> vertices;
+	std::vector<Run> runs;
+
+	GLuint vertexBuffer;
+	GLuint indexBuffer;
+	GLuint boundTexture;
+
+	int drawCalls;
+	int textureBinds;
+	int spriteCount;
+};
+
+}
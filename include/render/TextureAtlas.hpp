@@ -0,0 +1,46 @@
+#pragma once
+
+#include "AtlasBuilder.hpp"
+#include <GL/gl.h>
+#include <string>
+#include <vector>
+
+namespace render {
+
+// GL side of an atlas: one texture per page plus the region table, so any
+// sprite can be drawn knowing only its region id.
+struct TextureLevel {
+	int width;
+	int height;
+	const uint8_t* pixels;
+};
+
+class TextureAtlas {
+public:
+	// Levels kept per page. The builder pads regions by 4 texels, which
+	// keeps neighbours from bleeding into each other down to level 2.
+	enum { MIP_LEVELS = 3 };
+
+	TextureAtlas();
+
+	// All of these need a current GL context.
+	void upload(const AtlasBuilder& builder);
+	// Adds one page from ready-made BGRA levels, e.g. straight out of an
+	// asset pack.
+	void uploadPage(const TextureLevel* levels, int levelCount);
+	void setRegions(std::vector<AtlasRegion> regions, std::vector<std::string> names);
+	void destroy();
+
+	int find(const std::string& name) const;
+
+	const AtlasRegion& getRegion(int id) const { return regions[id]; }
+	GLuint getTexture(int page) const { return textures[page]; }
+	int getPageCount() const { return static_cast<int>(textures.size()); }
+
+private:
+	std::vector<GLuint> textures;
+	std::vector<AtlasRegion> regions;
+	std::vector<std::string> names;
+};
+
+}
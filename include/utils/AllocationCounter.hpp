@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+
+// Heap traffic through the global operator new and delete. Counted per
+// thread, so the simulation and the render thread can each check their own
+// work without seeing the other's. malloc calls made by C libraries (SDL,
+// the GL driver) are not counted.
+struct AllocationCounts {
+	uint64_t allocations;
+	uint64_t frees;
+	uint64_t bytes;
+};
+
+// Since the calling thread started
+AllocationCounts threadAllocations();
+
+// What the calling thread allocated since construction, e.g. over one
+// frame or one subsystem's update
+class AllocationScope {
+public:
+	AllocationScope() : start(threadAllocations()) {}
+
+	uint64_t allocations() const { return threadAllocations().allocations - start.allocations; }
+	uint64_t bytes() const { return threadAllocations().bytes - start.bytes; }
+
+private:
+	AllocationCounts start;
+};
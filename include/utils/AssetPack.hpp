@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Single-file container for ready-to-use asset data. The file is memory
+// mapped, so entries are read in place without copies or per-asset opens.
+//
+// Layout: PackHeader, then entryCount PackEntry records, then the entry data,
+// each blob aligned to 16 bytes.
+enum class PACK_ENTRY : uint32_t {
+	TEXTURE = 1,		// BGRA mip chain, level 0 first, width/height/levels set
+	ATLAS_REGIONS = 2,	// PackedRegion array
+	FONT_METRICS = 4,	// render::Font::saveMetrics() blob
+	LEVEL = 5			// Compiled level, see LevelFormat.hpp
+};
+
+struct PackHeader {
+	char magic[4];
+	uint32_t version;
+	uint32_t entryCount;
+	uint32_t reserved;
+};
+
+struct PackEntry {
+	char name[48];
+	PACK_ENTRY type;
+	uint32_t width;
+	uint32_t height;
+	uint32_t levels;
+	uint64_t offset;
+	uint64_t size;
+};
+
+class AssetPack {
+public:
+	static constexpr uint32_t VERSION = 1;
+
+	AssetPack();
+	~AssetPack();
+
+	AssetPack(const AssetPack&) = delete;
+	AssetPack& operator=(const AssetPack&) = delete;
+
+	bool open(const std::string& fileName);
+	void close();
+	bool isOpen() const { return base != nullptr; }
+
+	const PackEntry* find(const char* name) const;
+	const uint8_t* data(const PackEntry& entry) const { return base + entry.offset; }
+
+	const PackEntry* begin() const { return entries; }
+	const PackEntry* end() const { return entries + entryCount; }
+
+private:
+	const uint8_t* base;
+	size_t size;
+	const PackEntry* entries;
+	uint32_t entryCount;
+};
+
+class AssetPackWriter {
+public:
+	void add(const std::string& name, PACK_ENTRY type, const void* data, size_t size, uint32_t width = 0, uint32_t height = 0, uint32_t levels = 0);
+	// Appends to the blob added last, e.g. the next mip level of a texture
+	void append(const void* data, size_t size);
+
+	bool write(const std::string& fileName) const;
+
+private:
+	std::vector<PackEntry> entries;
+	std::vector<std::vector<uint8_t>> blobs;
+};
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "RollingStats.hpp"
+#include <chrono>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+// Paces a loop to a fixed rate on the monotonic clock. It sleeps until
+// shortly before each deadline and spins the rest of the way, since sleeps
+// routinely overshoot by a millisecond or more. Deadlines advance by exactly
+// one period, so the rate does not drift.
+//
+// With vsync on, the buffer swap does the blocking. onPresent() then
+// timestamps every swap and wait() only stands in if swaps stop blocking.
+class FramePacer {
+public:
+	using clock = std::chrono::steady_clock;
+
+	explicit FramePacer(double framesPerSecond = 60.0, clock::duration spinMargin = std::chrono::microseconds(1500))
+		: period{ std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(1.0 / framesPerSecond)) }
+		, spinMargin{ spinMargin }
+		, deadline{ clock::now() + period }
+		, lastFrame{ clock::now() }
+		, vsync{ false }
+		, fastSwaps{ 0 }
+	{
+	}
+
+	void setVsync(bool enabled) {
+		vsync = enabled;
+		fastSwaps = 0;
+	}
+
+	bool isVsync() const { return vsync; }
+
+	void wait() {
+		if (vsync) {
+			return;
+		}
+
+		auto now = clock::now();
+		if (now < deadline - spinMargin) {
+			std::this_thread::sleep_until(deadline - spinMargin);
+		}
+		while ((now = clock::now()) < deadline) {
+#if defined(__x86_64__) || defined(__i386__)
+			_mm_pause();
+#endif
+		}
+
+		record(now);
+
+		deadline += period;
+		if (now > deadline) {
+			// More than a whole period late: start over instead of bursting
+			// frames to catch up
+			deadline = now + period;
+		}
+	}
+
+	// Call right after the (blocking) buffer swap
+	void onPresent() {
+		if (!vsync) {
+			return;
+		}
+
+		auto now = clock::now();
+		if (now - lastFrame < period / 2) {
+			// The swap returned without waiting for vblank; pace by timer
+			if (++fastSwaps > 10) {
+				vsync = false;
+				deadline = now + period;
+			}
+		} else {
+			fastSwaps = 0;
+		}
+
+		record(now);
+	}
+
+	// Frame times in milliseconds
+	const RollingStats& getStats() const { return stats; }
+	clock::duration getPeriod() const { return period; }
+
+private:
+	void record(clock::time_point now) {
+		stats.add(std::chrono::duration<double, std::milli>(now - lastFrame).count());
+		lastFrame = now;
+	}
+
+	clock::duration period;
+	clock::duration spinMargin;
+	clock::time_point deadline;
+	clock::time_point lastFrame;
+	bool vsync;
+	int fastSwaps;
+
+	RollingStats stats;
+};
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Independent random streams. Every stream of every thread gets its own
+// generator, derived from the global seed, so subsystems never disturb each
+// other's sequences. LEVEL draws the same sequence on every thread, so a
+// seed gives the same levels in the game and in the headless tools.
+enum class RNG_STREAM {
+	LEVEL,
+	PHYSICS,
+	PARTICLES,
+	AUDIO,
+	COUNT
+};
+
+// PCG32 (XSH-RR): 64-bit state, 32-bit output, selectable stream.
+class Pcg32 {
+public:
+	Pcg32();
+	Pcg32(uint64_t seed, uint64_t sequence);
+
+	void seed(uint64_t seed, uint64_t sequence);
+
+	uint32_t next() {
+		uint64_t old = state;
+		state = old * MULTIPLIER + increment;
+		uint32_t xorShifted = static_cast<uint32_t>(((old >> 18u) ^ old) >> 27u);
+		uint32_t rot = static_cast<uint32_t>(old >> 59u);
+		return (xorShifted >> rot) | (xorShifted << ((32u - rot) & 31u));
+	}
+
+	// Uniform in [0, 1)
+	float nextFloat() {
+		return (next() >> 8) * (1.0f / 16777216.0f);
+	}
+
+	// Uniform in [min, max)
+	float range(float min, float max) {
+		return min + (max - min) * nextFloat();
+	}
+
+	// Uniform in [min, max], both ends included
+	int range(int min, int max);
+
+	void fill(uint32_t* out, size_t count);
+	void fill(float* out, size_t count, float min, float max);
+
+private:
+	static constexpr uint64_t MULTIPLIER = 6364136223846793005ULL;
+
+	uint64_t state;
+	uint64_t increment;
+};
+
+namespace rng {
+
+// Reseeds every stream on every thread. Threads pick the new seed up on their
+// next call to stream().
+void setSeed(uint64_t seed);
+uint64_t getSeed();
+
+// Generator for the calling thread. Streams other than LEVEL are numbered by
+// the order in which threads first draw from them, so runs are reproducible
+// as long as threads are started in the same order.
+Pcg32& stream(RNG_STREAM id);
+
+}
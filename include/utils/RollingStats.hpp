@@ -0,0 +1,74 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+// Fixed window of the most recent samples (frame times, latencies) with the
+// usual summary statistics. Never allocates.
+class RollingStats {
+public:
+	enum { CAPACITY = 240 };
+
+	RollingStats() : head(0), size(0) {}
+
+	void add(double sample) {
+		samples[head] = sample;
+		head = (head + 1) % CAPACITY;
+		size = std::min(size + 1, static_cast<int>(CAPACITY));
+	}
+
+	void clear() {
+		head = 0;
+		size = 0;
+	}
+
+	int count() const { return size; }
+
+	// i = 0 is the oldest sample in the window
+	double at(int i) const { return samples[(head - size + i + CAPACITY) % CAPACITY]; }
+	double last() const { return size ? at(size - 1) : 0.0; }
+
+	double mean() const {
+		double sum = 0.0;
+		for (int i = 0; i < size; ++i) {
+			sum += samples[i];
+		}
+		return size ? sum / size : 0.0;
+	}
+
+	double stddev() const {
+		double average = mean();
+		double sum = 0.0;
+		for (int i = 0; i < size; ++i) {
+			sum += (samples[i] - average) * (samples[i] - average);
+		}
+		return size > 1 ? std::sqrt(sum / (size - 1)) : 0.0;
+	}
+
+	double max() const {
+		double result = 0.0;
+		for (int i = 0; i < size; ++i) {
+			result = std::max(result, samples[i]);
+		}
+		return result;
+	}
+
+	// p in [0, 1]
+	double percentile(double p) const {
+		if (size == 0) {
+			return 0.0;
+		}
+		std::array<double, CAPACITY> sorted;
+		std::copy(samples.begin(), samples.begin() + size, sorted.begin());
+		int k = std::min(size - 1, static_cast<int>(std::ceil(p * size)) - 1);
+		k = std::max(k, 0);
+		std::nth_element(sorted.begin(), sorted.begin() + k, sorted.begin() + size);
+		return sorted[k];
+	}
+
+private:
+	std::array<double, CAPACITY> samples;
+	int head;
+	int size;
+};
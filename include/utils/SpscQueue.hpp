@@ -0,0 +1,51 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+// Lock-free bounded single-producer/single-consumer ring. Capacity must be a
+// power of two. Neither side ever blocks: push() fails when the ring is full.
+template <typename T, size_t Capacity>
+class SpscQueue {
+	static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+	SpscQueue() : head(0), tail(0) {}
+
+	SpscQueue(const SpscQueue&) = delete;
+	SpscQueue& operator=(const SpscQueue&) = delete;
+
+	// Producer side
+	bool push(const T& value) {
+		size_t position = tail.load(std::memory_order_relaxed);
+		if (position - head.load(std::memory_order_acquire) == Capacity) {
+			return false;
+		}
+		slots[position & MASK] = value;
+		tail.store(position + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Consumer side. front() is only valid while the queue is not empty.
+	bool empty() const {
+		return head.load(std::memory_order_relaxed) == tail.load(std::memory_order_acquire);
+	}
+	const T& front() const { return slots[head.load(std::memory_order_relaxed) & MASK]; }
+	void pop() { head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+	bool pop(T& value) {
+		if (empty()) {
+			return false;
+		}
+		value = front();
+		pop();
+		return true;
+	}
+
+private:
+	static constexpr size_t MASK = Capacity - 1;
+
+	T slots[Capacity];
+	alignas(64) std::atomic<size_t> head;
+	alignas(64) std::atomic<size_t> tail;
+};
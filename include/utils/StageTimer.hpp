@@ -0,0 +1,52 @@
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Wall-clock breakdown of a sequence of stages, e.g. startup. Work running
+// on other threads can be added next to it, but is not part of the total.
+class StageTimer {
+public:
+	using clock = std::chrono::steady_clock;
+
+	explicit StageTimer(const char* title) : title(title), start(clock::now()), stageStart(start) {}
+
+	// Ends the stage that started at the previous mark
+	void mark(const char* stage) {
+		auto now = clock::now();
+		stages.push_back(Stage{ stage, milliseconds(now - stageStart), false });
+		stageStart = now;
+	}
+
+	void addBackground(const std::string& stage, double ms) {
+		stages.push_back(Stage{ stage, ms, true });
+	}
+
+	double total() const { return milliseconds(stageStart - start); }
+
+	void report(FILE* out = stdout) const {
+		std::fprintf(out, "%s\n", title.c_str());
+		for (const auto& stage : stages) {
+			std::fprintf(out, "  %-28s %8.2f ms%s\n", stage.name.c_str(), stage.ms, stage.background ? "  (background)" : "");
+		}
+		std::fprintf(out, "  %-28s %8.2f ms\n", "total", total());
+	}
+
+private:
+	struct Stage {
+		std::string name;
+		double ms;
+		bool background;
+	};
+
+	static double milliseconds(clock::duration duration) {
+		return std::chrono::duration<double, std::milli>(duration).count();
+	}
+
+	std::string title;
+	clock::time_point start;
+	clock::time_point stageStart;
+	std::vector<Stage> stages;
+};
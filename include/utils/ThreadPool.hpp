@@ -0,0 +1,47 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Fixed set of worker threads for background jobs (asset decoding and the
+// like). Not meant for per-frame work.
+class ThreadPool {
+public:
+	// 0 picks one worker per hardware thread, keeping one for the caller
+	explicit ThreadPool(unsigned threads = 0);
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	template <typename F>
+	std::future<std::invoke_result_t<F>> submit(F&& job) {
+		using Result = std::invoke_result_t<F>;
+		auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(job));
+		std::future<Result> result = task->get_future();
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			jobs.emplace([task]() { (*task)(); });
+		}
+		available.notify_one();
+		return result;
+	}
+
+	unsigned size() const { return static_cast<unsigned>(workers.size()); }
+
+private:
+	void run();
+
+	std::vector<std::thread> workers;
+	std::queue<std::function<void()>> jobs;
+	std::mutex mutex;
+	std::condition_variable available;
+	bool stopping;
+};
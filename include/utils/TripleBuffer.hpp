@@ -0,0 +1,45 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Lock-free single-producer/single-consumer triple buffer. The writer fills
+// the back slot and publishes it; the reader always picks up the newest
+// published slot and never blocks the writer, stale slots are simply
+// overwritten.
+template <typename T>
+class TripleBuffer {
+public:
+	TripleBuffer() : middle(1), back(0), front(2) {}
+
+	TripleBuffer(const TripleBuffer&) = delete;
+	TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+	// Writer side
+	T& write() { return slots[back]; }
+	void publish() {
+		back = middle.exchange(back | DIRTY, std::memory_order_acq_rel) & INDEX;
+	}
+
+	// Reader side. Returns true if a newer slot was taken over.
+	bool update() {
+		if (!(middle.load(std::memory_order_relaxed) & DIRTY)) {
+			return false;
+		}
+		front = middle.exchange(front, std::memory_order_acq_rel) & INDEX;
+		return true;
+	}
+	const T& read() const { return slots[front]; }
+
+	// Direct access to every slot, only while neither side is running
+	T& slot(int index) { return slots[index]; }
+
+private:
+	static constexpr uint8_t INDEX = 0x3;
+	static constexpr uint8_t DIRTY = 0x4;
+
+	T slots[3];
+	alignas(64) std::atomic<uint8_t> middle;
+	alignas(64) uint8_t back;
+	alignas(64) uint8_t front;
+};
@@ -0,0 +1,239 @@
+#include "../include/Assets.hpp"
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+namespace {
+
+struct PackedRegion {
+	char name[48];
+	render::AtlasRegion region;
+};
+
+std::string executableDirectory() {
+	char* base = SDL_GetBasePath();
+	if (!base) {
+		return "./";
+	}
+	std::string directory = base;
+	SDL_free(base);
+	return directory;
+}
+
+std::string findAssetRoot() {
+	std::vector<std::string> candidates;
+	if (const char* fromEnvironment = std::getenv("JUNGLE_WAYS_ASSETS")) {
+		candidates.push_back(fromEnvironment);
+	}
+	std::string executable = executableDirectory();
+	candidates.push_back(executable + "assets");
+	candidates.push_back(executable + "../assets");
+#ifdef JUNGLE_WAYS_ASSET_DIR
+	candidates.push_back(JUNGLE_WAYS_ASSET_DIR);
+#endif
+	candidates.push_back("../assets");
+
+	for (const auto& candidate : candidates) {
+		std::error_code error;
+		if (std::filesystem::is_directory(candidate + "/sprites", error)) {
+			return candidate;
+		}
+	}
+	return "../assets";
+}
+
+}
+
+std::string assetPath(const std::string& relative) {
+	static const std::string root = findAssetRoot();
+	return root + "/" + relative;
+}
+
+std::string assetPackPath() {
+	return executableDirectory() + "assets.pack";
+}
+
+static std::vector<std::filesystem::path> listFiles(const std::string& directory, const char* extension) {
+	std::vector<std::filesystem::path> files;
+	std::error_code error;
+	for (const auto& entry : std::filesystem::directory_iterator(directory, error)) {
+		if (entry.is_regular_file() && entry.path().extension() == extension) {
+			files.push_back(entry.path());
+		}
+	}
+	std::sort(files.begin(), files.end());
+	return files;
+}
+
+std::vector<std::filesystem::path> listSprites(const std::string& directory) {
+	return listFiles(directory, ".png");
+}
+
+std::vector<std::filesystem::path> listLevels(const std::string& directory) {
+	return listFiles(directory, ".lvl");
+}
+
+bool compileLevels(const std::string& directory, std::vector<CompiledLevel>& levels, std::string& error) {
+	levels.clear();
+	for (const auto& file : listLevels(directory)) {
+		std::ifstream in(file);
+		if (!in) {
+			error = "could not open " + file.string();
+			return false;
+		}
+		std::stringstream text;
+		text << in.rdbuf();
+
+		CompiledLevel level;
+		level.name = file.stem().string();
+		if (!compileLevel(text.str(), level.blob, error)) {
+			error = file.string() + ", " + error;
+			return false;
+		}
+		levels.push_back(std::move(level));
+	}
+	return true;
+}
+
+void addBuiltinSprites(render::AtlasBuilder& builder) {
+	// Solid fills sample the middle of a white patch
+	render::Image white(4, 4);
+	std::fill(white.pixels.begin(), white.pixels.end(), 255);
+	builder.add("white", std::move(white));
+}
+
+bool rasterizeFonts(const std::string& fontFile, render::AtlasBuilder& builder, render::Font& menuFont, render::Font& hudFont) {
+	TTF_Font* menuTtf = TTF_OpenFont(fontFile.c_str(), MENU_FONT_SIZE);
+	TTF_Font* hudTtf = TTF_OpenFont(fontFile.c_str(), HUD_FONT_SIZE);
+
+	if (menuTtf) {
+		menuFont.rasterize(menuTtf, "menu", builder);
+		TTF_CloseFont(menuTtf);
+	}
+	if (hudTtf) {
+		hudFont.rasterize(hudTtf, "hud", builder);
+		TTF_CloseFont(hudTtf);
+	}
+
+	return menuTtf && hudTtf;
+}
+
+bool writeAssetPack(const render::AtlasBuilder& builder, const render::Font& menuFont, const render::Font& hudFont, const std::vector<CompiledLevel>& levels, const std::string& packFile) {
+	AssetPackWriter writer;
+
+	const auto& pages = builder.getPages();
+	for (size_t i = 0; i < pages.size(); ++i) {
+		std::vector<render::Image> mips = render::buildMipChain(pages[i], render::TextureAtlas::MIP_LEVELS);
+
+		writer.add("page" + std::to_string(i), PACK_ENTRY::TEXTURE, mips[0].pixels.data(), mips[0].pixels.size(), mips[0].width, mips[0].height, static_cast<uint32_t>(mips.size()));
+		for (size_t level = 1; level < mips.size(); ++level) {
+			writer.append(mips[level].pixels.data(), mips[level].pixels.size());
+		}
+	}
+
+	std::vector<PackedRegion> regions(builder.getRegions().size());
+	for (size_t i = 0; i < regions.size(); ++i) {
+		std::memset(&regions[i], 0, sizeof(PackedRegion));
+		std::strncpy(regions[i].name, builder.getNames()[i].c_str(), sizeof(regions[i].name) - 1);
+		regions[i].region = builder.getRegions()[i];
+	}
+	writer.add("regions", PACK_ENTRY::ATLAS_REGIONS, regions.data(), regions.size() * sizeof(PackedRegion), static_cast<uint32_t>(pages.size()));
+
+	std::vector<uint8_t> menuMetrics = menuFont.saveMetrics();
+	std::vector<uint8_t> hudMetrics = hudFont.saveMetrics();
+	writer.add("font/menu", PACK_ENTRY::FONT_METRICS, menuMetrics.data(), menuMetrics.size());
+	writer.add("font/hud", PACK_ENTRY::FONT_METRICS, hudMetrics.data(), hudMetrics.size());
+
+	for (const auto& level : levels) {
+		writer.add("level/" + level.name, PACK_ENTRY::LEVEL, level.blob.data(), level.blob.size());
+	}
+
+	return writer.write(packFile);
+}
+
+bool loadAtlasPack(const AssetPack& pack, render::TextureAtlas& atlas, render::Font& menuFont, render::Font& hudFont) {
+	const PackEntry* regionsEntry = pack.find("regions");
+	const PackEntry* menuEntry = pack.find("font/menu");
+	const PackEntry* hudEntry = pack.find("font/hud");
+	if (!regionsEntry || !menuEntry || !hudEntry || regionsEntry->size % sizeof(PackedRegion) != 0) {
+		return false;
+	}
+
+	GLint maxTextureSize = 0;
+	glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize);
+
+	uint32_t pageCount = regionsEntry->width;
+	std::vector<const PackEntry*> pages;
+	for (uint32_t i = 0; i < pageCount; ++i) {
+		const PackEntry* page = pack.find(("page" + std::to_string(i)).c_str());
+		if (!page || page->type != PACK_ENTRY::TEXTURE || page->levels == 0 || page->levels > render::TextureAtlas::MIP_LEVELS
+			|| page->width > static_cast<uint32_t>(maxTextureSize) || page->height > static_cast<uint32_t>(maxTextureSize)) {
+			return false;
+		}
+
+		uint64_t expected = 0;
+		for (uint32_t level = 0, width = page->width, height = page->height; level < page->levels; ++level) {
+			expected += static_cast<uint64_t>(width) * height * 4;
+			width = std::max(1u, width / 2);
+			height = std::max(1u, height / 2);
+		}
+		if (expected != page->size) {
+			return false;
+		}
+		pages.push_back(page);
+	}
+
+	if (!menuFont.loadMetrics(pack.data(*menuEntry), menuEntry->size) || !hudFont.loadMetrics(pack.data(*hudEntry), hudEntry->size)) {
+		return false;
+	}
+
+	size_t regionCount = regionsEntry->size / sizeof(PackedRegion);
+	std::vector<render::AtlasRegion> regions(regionCount);
+	std::vector<std::string> names(regionCount);
+	for (size_t i = 0; i < regionCount; ++i) {
+		PackedRegion packed;
+		std::memcpy(&packed, pack.data(*regionsEntry) + i * sizeof(PackedRegion), sizeof(PackedRegion));
+		packed.name[sizeof(packed.name) - 1] = '\0';
+		regions[i] = packed.region;
+		names[i] = packed.name;
+	}
+
+	atlas.destroy();
+	atlas.setRegions(std::move(regions), std::move(names));
+
+	for (const PackEntry* page : pages) {
+		render::TextureLevel levels[render::TextureAtlas::MIP_LEVELS];
+		const uint8_t* pixels = pack.data(*page);
+		int width = page->width;
+		int height = page->height;
+		for (uint32_t level = 0; level < page->levels; ++level) {
+			levels[level] = render::TextureLevel{ width, height, pixels };
+			pixels += static_cast<size_t>(width) * height * 4;
+			width = std::max(1, width / 2);
+			height = std::max(1, height / 2);
+		}
+		atlas.uploadPage(levels, page->levels);
+	}
+
+	return true;
+}
+
+bool loadLevelPack(const AssetPack& pack, std::vector<LevelData>& levels) {
+	levels.clear();
+	for (const PackEntry& entry : pack) {
+		if (entry.type != PACK_ENTRY::LEVEL) {
+			continue;
+		}
+		LevelData level;
+		if (!level.view(pack.data(entry), entry.size)) {
+			levels.clear();
+			return false;
+		}
+		levels.push_back(level);
+	}
+	return !levels.empty();
+}
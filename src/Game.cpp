@@ -1,146 +1,254 @@
 #include "../include/Game.hpp"
-#include "../include/utils/FPSLimiter.hpp"
+#include "../include/Assets.hpp"
+#include <algorithm>
 
 // Default constructor
-Game::Game(int width, int height) {
+Game::Game(int width, int height) : particles(MAX_PARTICLES), sceneRenderer(spriteBatch, atlas) {
 	this->width = width;
 	this->height = height;
 
 	isRunning = true;
 	gameState = GAME_STATE::MAIN_MENU;
+	resetRequest = RESET_NONE;
+	heldInput = 0;
+	pressedInput = 0;
+	droppedInputs = 0;
 	previousState = gameState;
 	pWindow = nullptr;
-	pRenderer = nullptr;
 	glContext = NULL;
-	pFont = nullptr;
 
 	score = 0;
+	levelVersion = 0;
+	cameraX = 0.0f;
+	streamedPage = -1;
+	leavesOwed = 0.0f;
+	playerGrounded = false;
+	playedTicks = 0;
+	tickMs = 0.0f;
+	tickAllocations = 0;
+	stepAllocations = 0;
+	steadyTicks = 0;
+	allocatingTicks = 0;
+
+	showPerfOverlay = false;
+	perfTextFrames = 0;
+	lastDrawCalls = 0;
+	lastSprites = 0;
+
+	lastFrameVersion = 0;
+	steadyFrames = 0;
+	allocatingFrames = 0;
+
+	tickPacer = FramePacer(1.0 / tick);
+
+	backgroundSprite = -1;
+	characterSprite = -1;
+	treeSprite = -1;
+	branchSprite = -1;
+	fruitSprite = -1;
+	vineSprite = -1;
+	whiteSprite = -1;
 
 	world.gravity = physics::Vec2(0, 9.81f);
-	world.iterations = 10;
-	world.bodies.reserve(8);
+	world.iterations = 2;
+	world.bodies.reserve(32);
 	world.joints.reserve(1);
+	world.arbiters.reserve(64);
 
-	initialTree = new physics::Body();
-	finalTree = new physics::Body();
-	initialBranch = new physics::Body();
-	finalBranch = new physics::Body();
-	anotherBranch = new physics::Body();
-	character = new physics::Body();
-	fruit = new physics::Body();
+	for (int i = 0; i < 3; ++i) {
+		renderStates.slot(i).sprites.reserve(64);
+		renderStates.slot(i).staticSprites.reserve(64);
+		renderStates.slot(i).particles.reserve(MAX_PARTICLES);
+	}
+
+	// Owns nothing but its body; the sprite is filled in once the atlas is loaded
+	player = registry.create(Transform{ physics::Vec2(0.0f, 0.0f), physics::Vec2(0.0f, 0.0f) }, PhysicsBody{ &playerBody }, Sprite{ -1, SPRITE_LAYER::DYNAMIC }, Player{ -40.0f });
 }
 
 void Game::LevelDesign(bool resetCount) {
-	initialBranch->set(physics::Vec2(initialTree->width.x * 2, initialTree->width.y / 20.0f), FLT_MAX);
-	initialBranch->textureId = branchTextureId;
-
-	finalBranch->set(physics::Vec2(initialBranch->width.x, initialBranch->width.y), FLT_MAX);
-	finalBranch->textureId = branchTextureId;
-
-	anotherBranch->set(physics::Vec2(initialTree->width.x * 2, initialTree->width.y / 20.0f), FLT_MAX);
-	anotherBranch->textureId = branchTextureId;
+	if (resetCount) {
+		score = 0;
+	}
 
-	character->width.x = (initialTree->width.y / 20.0f) * 1.9f;
+	physics::Body* character = registry.get<PhysicsBody>(player).body;
+	character->width.x = (height / 20.0f) * 1.9f;
 	character->width.y = 1.705882353F * character->width.x;
-	character->set(character->width, 0.01f);
-	character->textureId = characterTextureId;
+	// Rounded feet slide over branch corners instead of catching on them,
+	// and the character stays upright
+	character->fixedRotation = true;
+	character->set(character->width, 0.01f, physics::SHAPE::CAPSULE);
+	character->friction = 2.0f;
 
-	fruit->set(physics::Vec2(character->width.x, character->width.x), 0.01f);
-	fruit->textureId = fruitTextureId;
+	// Levels cycle as the score goes up
+	Pcg32& random = rng::stream(RNG_STREAM::LEVEL);
+	uint64_t seed = (static_cast<uint64_t>(random.next()) << 32) | random.next();
+	level.reset(levels[score % levels.size()], seed, score);
 
-	initialBranch->position.set(initialTree->position.x + initialTree->width.x / 2.0f + initialBranch->width.x / 2.0f, randomFloat(initialTree->position.y * 0.15f + character->width.y / 2.0f + initialBranch->width.y / 2.0f, initialTree->position.y * 1.875f));
-	finalBranch->position.set(width - initialBranch->position.x, randomFloat(initialTree->position.y * 0.15f + character->width.y / 2.0f + finalBranch->width.y / 2.0f, initialTree->position.y * 1.875f));
-	if (resetCount) {
-		score = 0;
-	}
+	character->position = level.getSpawn(character->width);
+	world.add(character);
 
-	anotherBranch->velocity.y = randomInt(5 * ((score / 2.0f) + 1), 15 * ((score / 4.0f) + 1));
-	fruit->position.set(finalBranch->position.x, finalBranch->position.y - finalBranch->width.y / 2.0f - fruit->width.y / 2.0f);
-	world.add(fruit);
+	registry.get<Transform>(player) = Transform{ character->position, character->width };
+	registry.get<Sprite>(player).id = characterSprite;
 
-	world.add(initialBranch);
-	world.add(finalBranch);
+	streamedPage = -1;
+	UpdateCamera();
+}
 
-	anotherBranch->position.set(width / 2.0f, height / 2.0f);
-	world.add(anotherBranch);
+void Game::UpdateCamera() {
+	float maxX = std::max(level.getWidth() - width, 0.0f);
+	// Whole pixels, so the cached static layer maps texel to pixel
+	cameraX = std::floor(std::min(std::max(registry.get<Transform>(player).position.x - width / 2.0f, 0.0f), maxX));
+
+	// Chunks stream in a screen ahead of the cached static layer on either
+	// side, so they never appear in view
+	int page = static_cast<int>(cameraX / width);
+	if (page != streamedPage) {
+		level.stream(world, registry, (page - 1) * static_cast<float>(width), (page + STATIC_LAYER_PAGES + 1) * static_cast<float>(width));
+		streamedPage = page;
+		++levelVersion;
+		UpdateParticleGeometry();
+	}
+}
 
-	character->friction = 2.0f;
-	character->position.set(initialBranch->position.x, initialBranch->position.y - initialBranch->width.y / 2.0f - character->width.y / 2.0f);
-	world.add(character);
+void Game::UpdateParticleGeometry() {
+	particleGeometry.clear();
+	registry.each<Transform, Sprite>([&](Transform& transform, Sprite& sprite) {
+		if (sprite.layer == SPRITE_LAYER::STATIC) {
+			physics::Vec2 half = 0.5f * transform.size;
+			particleGeometry.push_back(fx::StaticBox{ transform.position.x - half.x, transform.position.y - half.y, transform.position.x + half.x, transform.position.y + half.y });
+		}
+	});
+	particles.setStaticGeometry(particleGeometry);
 }
 
-void Game::LoadTextures() {
-    characterTextureId = LoadImageIntoTexture("../assets/sprites/character.png");
-    treeTextureId = LoadImageIntoTexture("../assets/sprites/tree.png");
-    branchTextureId = LoadImageIntoTexture("../assets/sprites/branch.png");
-	backgroundTextureId = LoadImageIntoTexture("../assets/sprites/background.png");
-	fruitTextureId = LoadImageIntoTexture("../assets/sprites/fruit.png");
+void Game::DecodeSprites() {
+	assetWorkers = std::make_unique<ThreadPool>();
+	for (const auto& file : listSprites(assetPath("sprites"))) {
+		std::string fileName = file.string();
+		pendingSprites.push_back(PendingSprite{ file.stem().string(), assetWorkers->submit([fileName]() {
+			auto start = StageTimer::clock::now();
+			DecodedSprite decoded;
+			decoded.loaded = render::loadImage(fileName.c_str(), decoded.image);
+			decoded.ms = std::chrono::duration<double, std::milli>(StageTimer::clock::now() - start).count();
+			return decoded;
+		}) });
+	}
 }
 
-GLuint Game::LoadImageIntoTexture(const char* fileName) {
-    FREE_IMAGE_FORMAT format = FreeImage_GetFileType(fileName, 0);
-    FIBITMAP* image = FreeImage_Load(format, fileName);
-    FIBITMAP* image32bits = FreeImage_ConvertTo32Bits(image);
-    int width = FreeImage_GetWidth(image32bits);
-    int height = FreeImage_GetHeight(image32bits);
+void Game::LoadTextures(StageTimer& timer) {
+	if (assetPack.isOpen() && loadAtlasPack(assetPack, atlas, menuFont, hudFont)) {
+		timer.mark("atlas upload from pack");
+	} else {
+		if (pendingSprites.empty()) {
+			DecodeSprites();
+		}
+		BuildAtlas(timer);
+	}
 
-    // Generate a new texture ID
-    GLuint textureId;
-    glGenTextures(1, &textureId);
+	characterSprite = atlas.find("character");
+	treeSprite = atlas.find("tree");
+	branchSprite = atlas.find("branch");
+	backgroundSprite = atlas.find("background");
+	fruitSprite = atlas.find("fruit");
+	vineSprite = atlas.find("vine");
+	whiteSprite = atlas.find("white");
+	sceneRenderer.setBackground(backgroundSprite);
+}
 
-    // Bind the texture
-    glBindTexture(GL_TEXTURE_2D, textureId);
+bool Game::LoadLevels(StageTimer& timer) {
+	// Pack levels are used in place, the pack stays mapped until exit
+	if (assetPack.isOpen() && loadLevelPack(assetPack, levels)) {
+		timer.mark("levels from pack");
+		return true;
+	}
 
-    // Set texture parameters
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	std::string error;
+	if (!compileLevels(assetPath("levels"), compiledLevels, error)) {
+		std::cerr << "Could not compile level " << error << std::endl;
+		return false;
+	}
+	levels.clear();
+	for (const auto& compiled : compiledLevels) {
+		LevelData data;
+		data.view(compiled.blob.data(), compiled.blob.size());
+		levels.push_back(data);
+	}
+	timer.mark("level compile");
 
-    // Load the image data into the texture
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_BGRA, GL_UNSIGNED_BYTE, (void*)FreeImage_GetBits(image32bits));
+	if (levels.empty()) {
+		std::cerr << "No levels in " << assetPath("levels") << std::endl;
+		return false;
+	}
+	return true;
+}
 
-    // Unload the image data
-    FreeImage_Unload(image);
-    FreeImage_Unload(image32bits);
+void Game::BuildAtlas(StageTimer& timer) {
+	GLint maxTextureSize = 0;
+	glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize);
 
-    // Unbind the texture
-    glBindTexture(GL_TEXTURE_2D, 0);
+	render::AtlasBuilder builder(std::min(maxTextureSize, 4096));
 
-    // Return the texture ID
-    return textureId;
+	// Glyphs first, the sprite decodes may still be running
+	rasterizeFonts(assetPath("fonts/tarzan-regular.ttf"), builder, menuFont, hudFont);
+	timer.mark("glyph rasterization");
+
+	double decodeMs = 0.0;
+	for (auto& pending : pendingSprites) {
+		DecodedSprite decoded = pending.decoded.get();
+		decodeMs += decoded.ms;
+		if (decoded.loaded) {
+			builder.add(pending.name, std::move(decoded.image));
+		} else {
+			std::cerr << "Could not decode sprite " << pending.name << std::endl;
+		}
+	}
+	timer.addBackground("sprite decode (" + std::to_string(pendingSprites.size()) + " files)", decodeMs);
+	pendingSprites.clear();
+	assetWorkers.reset();
+	timer.mark("waiting for decodes");
+
+	addBuiltinSprites(builder);
+	builder.build();
+	timer.mark("atlas packing");
+	atlas.upload(builder);
+	timer.mark("texture upload");
 }
 
 void Game::ResetGame(bool resetCount) {
 	world.clear();
+	level.unload(world, registry);
+	particles.clear();
+	++levelVersion;
 
-	initialTree->set(physics::Vec2(width / 12.5f, height), FLT_MAX);
-	initialTree->textureId = treeTextureId;
-	initialTree->position.set(width / 12.5f, height / 2.0f);
-	initialTree->friction = 0;
-	world.add(initialTree);
-
-	finalTree->set(physics::Vec2(width / 12.5f, height), FLT_MAX);
-	finalTree->textureId = treeTextureId;
-	finalTree->position.set(width - initialTree->position.x, height / 2.0f);
-	finalTree->friction = 0;
-	world.add(finalTree);
-
+	level.configure(width, height, treeSprite, branchSprite, fruitSprite, vineSprite);
 	LevelDesign(resetCount);
 }
 
 bool Game::OnInit() {
+	StageTimer timer("Startup");
+
+	// A prebuilt asset pack is uploaded as is. Without one, PNG decoding runs
+	// on worker threads while SDL, the window and the GL context come up.
+	if (!assetPack.open(assetPackPath())) {
+		DecodeSprites();
+	}
+	timer.mark("asset pack / decode dispatch");
+
 	if (SDL_Init(SDL_INIT_EVERYTHING) < 0) {
 		return false;
 	}
+	timer.mark("SDL_Init");
 
-	pWindow = SDL_CreateWindow("Jungle Ways", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, width, height, SDL_WINDOW_SHOWN | SDL_WINDOW_OPENGL);
-	if (!pWindow) {
-		return false;
+	if (!mixer.open(assetPath("music/jungle.wav"))) {
+		std::fprintf(stderr, "No audio: %s\n", SDL_GetError());
 	}
+	timer.mark("audio");
 
-	pRenderer = SDL_CreateRenderer(pWindow, -1, SDL_RENDERER_ACCELERATED);
-	if (!pRenderer) {
+	pWindow = SDL_CreateWindow("Jungle Ways", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, width, height, SDL_WINDOW_SHOWN | SDL_WINDOW_OPENGL);
+	if (!pWindow) {
 		return false;
 	}
+	timer.mark("window");
 
 	if (TTF_Init() < 0) {
 		return false;
@@ -150,51 +258,145 @@ bool Game::OnInit() {
 	if (!glContext) {
 		return false;
 	}
+	timer.mark("GL context");
 
-	pFont = TTF_OpenFont("../assets/fonts/tarzan-regular.ttf", 50);
-	if (!pFont) {
+	LoadTextures(timer);
+	if (!LoadLevels(timer)) {
 		return false;
 	}
-
-	LoadTextures();
+	spriteBatch.init();
+	sceneRenderer.init(width, height, STATIC_LAYER_PAGES);
 
 	glEnable(GL_COLOR_MATERIAL);
+	glEnable(GL_TEXTURE_2D);
+	glEnable(GL_BLEND);
+	// Keep destination alpha opaque, the static layer is composited with it
+	glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+	glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
+
+	// Let the swap pace rendering when the driver honours vsync
+	framePacer.setVsync(SDL_GL_SetSwapInterval(1) == 0);
 	glMatrixMode(GL_PROJECTION);
 	glLoadIdentity();
 	glOrtho(0, width, height, 0, -1, 1);
 	glMatrixMode(GL_MODELVIEW);
 	glLoadIdentity();
+	timer.mark("GL state");
+
+	timer.report();
 
 	return true;
 }
 
-void Game::handleCharacter() {
-	if (keyboardStateArray[SDL_SCANCODE_A]) {
-		world.bodies[character->id]->velocity.x = -newVel(score);
+void Game::QueueInput(SDL_Scancode scancode, bool pressed) {
+	uint32_t input = 0;
+	if (scancode == SDL_SCANCODE_A) {
+		input = INPUT_LEFT;
+	} else if (scancode == SDL_SCANCODE_D) {
+		input = INPUT_RIGHT;
+	} else if (scancode == SDL_SCANCODE_SPACE) {
+		input = INPUT_JUMP;
+	} else {
+		return;
+	}
+
+	PushInput(input, pressed);
+}
+
+void Game::PushInput(uint32_t input, bool pressed) {
+	// Stamped as polled. SDL's own event timestamps only have millisecond
+	// resolution and come from another clock.
+	if (!inputEvents.push(InputEvent{ InputEvent::clock::now(), input, pressed })) {
+		++droppedInputs;
+	}
+}
+
+void Game::RecordInput(const std::string& fileName) {
+	recordingFile = fileName;
+	recording.reserve(4096);
+}
+
+bool Game::SaveInputRecording() const {
+	FILE* out = std::fopen(recordingFile.c_str(), "w");
+	if (!out) {
+		return false;
 	}
-	if (keyboardStateArray[SDL_SCANCODE_D]) {
-		world.bodies[character->id]->velocity.x = newVel(score);
+	std::fprintf(out, "# Jungle Ways input recording: <tick> <input bits> <1 pressed, 0 released>\n");
+	std::fprintf(out, "seed %llu\n", static_cast<unsigned long long>(rng::getSeed()));
+	for (const auto& record : recording) {
+		std::fprintf(out, "%llu %u %d\n", static_cast<unsigned long long>(record.tick), record.input, record.pressed ? 1 : 0);
 	}
-	if (keyboardStateArray[SDL_SCANCODE_SPACE] && world.bodies[character->id]->canJump) {
-		world.bodies[character->id]->velocity.y = -40.0f;
+	return std::fclose(out) == 0;
+}
+
+void Game::ApplyInput() {
+	auto tickTime = InputEvent::clock::now();
+
+	// Everything queued happened before this tick started, so this is the
+	// tick it belongs to. Presses are latched, a tap shorter than a tick
+	// still counts.
+	InputEvent event;
+	while (inputEvents.pop(event)) {
+		if (!recordingFile.empty()) {
+			recording.push_back(InputRecord{ playedTicks, event.input, event.pressed });
+		}
+		if (event.pressed) {
+			heldInput |= event.input;
+			pressedInput |= event.input;
+			inputToTick.add(std::chrono::duration<double, std::milli>(tickTime - event.time).count());
+			lastInputTime = event.time;
+		} else {
+			heldInput &= ~event.input;
+		}
 	}
 }
 
+void Game::handleCharacter() {
+	uint32_t input = heldInput | pressedInput;
+	float speed = newVel(score);
+
+	registry.each<PhysicsBody, Player>([&](PhysicsBody& physicsBody, Player& playerState) {
+		physics::Body* body = physicsBody.body;
+		if (input & INPUT_LEFT) {
+			body->velocity.x = -speed;
+		}
+		if (input & INPUT_RIGHT) {
+			body->velocity.x = speed;
+		}
+		if ((input & INPUT_JUMP) && body->canJump) {
+			body->velocity.y = playerState.jumpVelocity;
+			PlaySoundAt(audio::SOUND::JUMP, body->position.x);
+		}
+	});
+}
+
 int Game::OnExecute() {
 	SDL_Event event;
 	if (!OnInit()) return -1;
 
-	// FPSLimiter fps(505);
+	// Simulation ticks on its own thread; this one only handles events and
+	// draws the newest published tick.
+	simulationThread = std::thread(&Game::SimulationLoop, this);
+
 	while(isRunning) {
 		while((SDL_PollEvent(&event)) != 0) {
 			OnEvent(&event);
 		}
-		handleCharacter();
-		OnLoop();
 		OnRender();
-		// fps.run();
+		framePacer.onPresent();
+		framePacer.wait();
 	}
 
+	simulationThread.join();
+	ReportInputLatency(stdout);
+	ReportAllocations(stdout);
+	if (!recordingFile.empty()) {
+		if (SaveInputRecording()) {
+			std::printf("Input recorded to %s\n", recordingFile.c_str());
+		} else {
+			std::fprintf(stderr, "Could not write %s\n", recordingFile.c_str());
+		}
+	}
 	OnExit();
 	return 0;
 }
@@ -204,6 +406,17 @@ void Game::OnEvent(SDL_Event* event) {
 		isRunning = false;
 	}
 
+	if (event->type == SDL_KEYDOWN && event->key.keysym.sym == SDLK_F3 && !event->key.repeat) {
+		showPerfOverlay = !showPerfOverlay;
+		perfTextFrames = 0;
+	}
+
+	// Movement goes to the simulation thread in every state, so no key is
+	// left held down across a menu
+	if ((event->type == SDL_KEYDOWN || event->type == SDL_KEYUP) && !event->key.repeat) {
+		QueueInput(event->key.keysym.scancode, event->type == SDL_KEYDOWN);
+	}
+
 	if (gameState == GAME_STATE::IN_GAME_MENU) {
 		previousState = GAME_STATE::IN_GAME_MENU;
 		if (event->type == SDL_KEYDOWN) {
@@ -219,7 +432,7 @@ void Game::OnEvent(SDL_Event* event) {
 		previousState = GAME_STATE::MAIN_MENU;
 		if (event->type == SDL_KEYDOWN) {
 			if (event->key.keysym.sym == SDLK_1) {
-				ResetGame(true);
+				resetRequest = RESET_SCORE;
 				gameState = GAME_STATE::PLAYING;
 			} else if (event->key.keysym.sym == SDLK_2) {
 				gameState = GAME_STATE::OPTIONS_SUB_MENU;
@@ -230,9 +443,9 @@ void Game::OnEvent(SDL_Event* event) {
 	} else if (gameState == GAME_STATE::OPTIONS_SUB_MENU) {
 		if (event->type == SDL_KEYDOWN) {
 			if (event->key.keysym.sym == SDLK_1) {
-				// Nothing yet
+				mixer.setAmbient(!mixer.isAmbientOn());
 			} else if (event->key.keysym.sym == SDLK_2) {
-				// Nothing yet
+				mixer.setMusic(!mixer.isMusicOn());
 			} else if (event->key.keysym.sym == SDLK_3) {
 				if (previousState == GAME_STATE::MAIN_MENU) {
 					gameState = GAME_STATE::MAIN_MENU;
@@ -248,20 +461,120 @@ void Game::OnEvent(SDL_Event* event) {
 				gameState = GAME_STATE::IN_GAME_MENU;
 			}
 			if (event->key.keysym.sym == SDLK_r) {
-				ResetGame(true);
+				resetRequest = RESET_SCORE;
 			}
 		}
 	}
 }
 
+void Game::SimulationLoop() {
+	while (isRunning) {
+		OnLoop();
+		tickPacer.wait();
+	}
+}
+
 void Game::OnLoop() {
+	auto tickStart = std::chrono::steady_clock::now();
+	AllocationScope tickScope;
+	uint64_t version = levelVersion;
+	bool playing = gameState == GAME_STATE::PLAYING;
+
+	int request = resetRequest.exchange(RESET_NONE);
+	if (request != RESET_NONE) {
+		ResetGame(request == RESET_SCORE);
+	}
+
+	if (gameState == GAME_STATE::PLAYING) {
+		PlayTick();
+	} else {
+		ApplyInput();
+		pressedInput = 0;
+	}
+
+	tickMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - tickStart).count();
+	PublishRenderState();
+
+	tickAllocations = static_cast<uint32_t>(tickScope.allocations());
+	if (playing && gameState == GAME_STATE::PLAYING && levelVersion == version) {
+		++steadyTicks;
+		if (tickAllocations) {
+			++allocatingTicks;
+		}
+	}
+}
+
+void Game::PlayTick() {
+	ApplyInput();
+	handleCharacter();
+	Logic();
+	pressedInput = 0;
+	++playedTicks;
+}
+
+uint64_t Game::LevelVersion() const {
+	return levelVersion;
+}
+
+void Game::PublishRenderState() {
+	render::RenderSnapshot& snapshot = renderStates.write();
+
+	// Moving sprites are culled to the view, static ones to the span of
+	// the cached static layer
+	float viewX0 = cameraX;
+	float viewX1 = cameraX + width;
+	float layerX0 = streamedPage * static_cast<float>(width);
+	float layerX1 = layerX0 + width * STATIC_LAYER_PAGES;
+
+	snapshot.sprites.clear();
+	snapshot.staticSprites.clear();
+	registry.each<Transform, Sprite>([&](Transform& transform, Sprite& spriteState) {
+		if (spriteState.id < 0) {
+			return;
+		}
+
+		float halfWidth = transform.size.x / 2.0f;
+		float halfHeight = transform.size.y / 2.0f;
+		render::SpriteInstance sprite{ spriteState.id, transform.position.x - halfWidth, transform.position.y - halfHeight, transform.position.x + halfWidth, transform.position.y + halfHeight };
+		if (spriteState.layer == SPRITE_LAYER::STATIC) {
+			if (sprite.x1 > layerX0 && sprite.x0 < layerX1) {
+				snapshot.staticSprites.push_back(sprite);
+			}
+		} else if (sprite.x1 > viewX0 && sprite.x0 < viewX1) {
+			snapshot.sprites.push_back(sprite);
+		}
+	});
+	snapshot.particles.clear();
+	particles.publish(snapshot.particles, whiteSprite, viewX0, viewX1);
+	snapshot.liveParticles = particles.getCount();
+	snapshot.staticVersion = levelVersion;
+	snapshot.staticOriginX = layerX0;
+	snapshot.cameraX = cameraX;
+	snapshot.inputTime = lastInputTime;
+	snapshot.score = score;
+	snapshot.step = world.stats;
+	snapshot.tickMs = tickMs;
+	snapshot.tickAllocations = tickAllocations;
+	snapshot.stepAllocations = stepAllocations;
+	snapshot.tick = playedTicks;
+
+	renderStates.publish();
 }
 
 void Game::OnRender() {
-	SDL_SetRenderDrawColor(pRenderer, 255, 255, 255, 255);
-	SDL_RenderClear(pRenderer);
+	AllocationScope frameScope;
+	bool playing = gameState == GAME_STATE::PLAYING;
+	if (playing) {
+		renderStates.update();
+		sceneRenderer.prepare(renderStates.read());
+	}
+
+	// While playing, the opaque static layer covers every pixel
+	if (!playing || !sceneRenderer.isLayerReady()) {
+		glClear(GL_COLOR_BUFFER_BIT);
+	}
 
-	SDL_GL_MakeCurrent(pWindow, glContext);
+	spriteBatch.begin();
 
 	if (gameState == GAME_STATE::IN_GAME_MENU) {
 		RenderInGameMenu();
@@ -269,40 +582,70 @@ void Game::OnRender() {
 		RenderOptionsMenu();
 	} else if (gameState == GAME_STATE::MAIN_MENU) {
 		RenderMainMenu();
-	} else if (gameState == GAME_STATE::PLAYING) {
-		RenderScene();
+	} else if (playing) {
+		RenderScene(renderStates.read());
 	}
 
+	if (showPerfOverlay) {
+		RenderPerfOverlay(renderStates.read());
+	}
+
+	spriteBatch.end();
+	lastDrawCalls = spriteBatch.getDrawCalls();
+	lastSprites = spriteBatch.getSpriteCount();
+
+	if (playing && !showPerfOverlay && renderStates.read().staticVersion == lastFrameVersion) {
+		++steadyFrames;
+		if (frameScope.allocations()) {
+			++allocatingFrames;
+		}
+	}
+	lastFrameVersion = playing ? renderStates.read().staticVersion : 0;
+
 	SDL_GL_SwapWindow(pWindow);
+
+	// The swap returning is as close to the photons as we can see
+	if (playing && renderStates.read().inputTime != presentedInputTime) {
+		presentedInputTime = renderStates.read().inputTime;
+		inputToPresent.add(std::chrono::duration<double, std::milli>(InputEvent::clock::now() - presentedInputTime).count());
+	}
+}
+
+void Game::ReportInputLatency(FILE* out) const {
+	std::fprintf(out, "Input latency, last %d presses\n", inputToTick.count());
+	std::fprintf(out, "  %-20s mean %6.2f ms  p99 %6.2f ms  max %6.2f ms\n", "to simulation", inputToTick.mean(), inputToTick.percentile(0.99), inputToTick.max());
+	std::fprintf(out, "  %-20s mean %6.2f ms  p99 %6.2f ms  max %6.2f ms\n", "to present", inputToPresent.mean(), inputToPresent.percentile(0.99), inputToPresent.max());
+	if (droppedInputs) {
+		std::fprintf(out, "  %d events dropped, queue full\n", droppedInputs);
+	}
+}
+
+void Game::ReportAllocations(FILE* out) const {
+	std::fprintf(out, "Heap allocations while playing\n");
+	std::fprintf(out, "  %-20s %d of %d steady ticks allocated\n", "simulation", allocatingTicks, steadyTicks);
+	std::fprintf(out, "  %-20s %d of %d steady frames allocated\n", "render", allocatingFrames, steadyFrames);
 }
 
 void Game::OnExit() {
-	SDL_DestroyRenderer(pRenderer);
+	spriteBatch.destroy();
+	sceneRenderer.destroy();
+	atlas.destroy();
 	SDL_DestroyWindow(pWindow);
 	SDL_GL_DeleteContext(glContext);
-	TTF_CloseFont(pFont);
-	pRenderer = nullptr;
 	pWindow = nullptr;
 	glContext = NULL;
-	pFont = nullptr;
-
-	delete initialTree;
-	delete finalTree;
-	delete initialBranch;
-	delete finalBranch;
-	delete anotherBranch;
-	delete character;
-	delete fruit;
+
 	world.clear();
+	level.unload(world, registry);
+	registry.clear();
+	levels.clear();
+	assetPack.close();
+	mixer.close();
 	TTF_Quit();
 	SDL_Quit();
 }
 
 void Game::RenderMainMenu() {
-	glClear(GL_COLOR_BUFFER_BIT);
-
-	glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
-
 	SDL_Color textColor = {0, 0, 0, 255};
 
 	// Calculate menu dimensions
@@ -314,9 +657,7 @@ void Game::RenderMainMenu() {
 	int menuY = (height - menuHeight) / 2;
 
 	// Render the menu background
-	SDL_SetRenderDrawColor(pRenderer, 192, 192, 192, 255);
-	SDL_Rect menuRect = { menuX, menuY, menuWidth, menuHeight };
-	SDL_RenderFillRect(pRenderer, &menuRect);
+	FillRect(menuX, menuY, menuWidth, menuHeight, render::packColor(192, 192, 192));
 
 	// Render each option
 	int optionCount = 3;
@@ -351,20 +692,18 @@ void Game::RenderOptionsMenu() {
 	int menuX = static_cast<int>((width - menuWidth) / 2.0f);
 	int menuY = static_cast<int>((height - menuHeight) / 2.0f);
 
-	SDL_SetRenderDrawColor(pRenderer, 192, 192, 192, 255);
-	SDL_Rect menuRect{ menuX, menuY, menuWidth, menuHeight };
-	SDL_RenderFillRect(pRenderer, &menuRect);
+	FillRect(menuX, menuY, menuWidth, menuHeight, render::packColor(192, 192, 192));
 
 	int optionCount = 3;
 	int optionHeight = menuHeight / optionCount;
 	int optionY = menuY;
 
-	// Option 1: General Sound
-	RenderMenuOption("Ambient Sound", menuX, optionY, menuWidth, optionHeight, textColor);
+	// Option 1: Ambient sound
+	RenderMenuOption(mixer.isAmbientOn() ? "Ambient Sound: On" : "Ambient Sound: Off", menuX, optionY, menuWidth, optionHeight, textColor);
 	optionY += optionHeight;
 
-	// Option 2: Options
-	RenderMenuOption("Music", menuX, optionY, menuWidth, optionHeight, textColor);
+	// Option 2: Music
+	RenderMenuOption(mixer.isMusicOn() ? "Music: On" : "Music: Off", menuX, optionY, menuWidth, optionHeight, textColor);
 	optionY += optionHeight;
 
 	// Option 3: Return to the previous menu
@@ -383,9 +722,7 @@ void Game::RenderInGameMenu() {
 	int menuY = static_cast<int>((height - menuHeight) / 2.0f);
 
 	// Render the menu background
-	SDL_SetRenderDrawColor(pRenderer, 192, 192, 192, 255);
-	SDL_Rect menuRect{ menuX, menuY, menuWidth, menuHeight };
-	SDL_RenderFillRect(pRenderer, &menuRect);
+	FillRect(menuX, menuY, menuWidth, menuHeight, render::packColor(192, 192, 192));
 
 	// Render each option
 	int optionCount = 3;
@@ -405,92 +742,183 @@ void Game::RenderInGameMenu() {
 }
 
 void Game::RenderMenuOption(const char* optionText, int x, int y, int width, int height, SDL_Color textColor) {
-	SDL_Surface* surface = TTF_RenderText_Solid(pFont, optionText, textColor);
-	SDL_Texture* texture = SDL_CreateTextureFromSurface(pRenderer, surface);
-	int textWidth = surface->w;
-	int textHeight = surface->h;
-	SDL_FreeSurface(surface);
+	const render::TextLayout& text = menuFont.layout(optionText);
+	menuFont.draw(spriteBatch, atlas, optionText, x + (width - text.width) / 2.0f, y + (height - text.height) / 2.0f, render::packColor(textColor.r, textColor.g, textColor.b, textColor.a));
 
-	SDL_Rect textRect{ x + (width - textWidth) / 2, y + (height - textHeight) / 2, textWidth, textHeight };
-	SDL_RenderCopy(pRenderer, texture, NULL, &textRect);
-	SDL_DestroyTexture(texture);
+	DrawRect(x, y, width, height, render::packColor(0, 0, 0));
+}
 
-	SDL_SetRenderDrawColor(pRenderer, 0, 0, 0, 255);
-	SDL_Rect rect{ x, y, width, height };
-	SDL_RenderDrawRect(pRenderer, &rect);
+void Game::FillRect(int x, int y, int width, int height, uint32_t color) {
+	const render::AtlasRegion& region = atlas.getRegion(whiteSprite);
+	float u = (region.uv.u0 + region.uv.u1) / 2.0f;
+	float v = (region.uv.v0 + region.uv.v1) / 2.0f;
+	spriteBatch.draw(atlas.getTexture(region.page), x, y, x + width, y + height, render::UVRect{ u, v, u, v }, color);
 }
 
-void Game::Logic() {
-	world.step(tick);
+void Game::DrawRect(int x, int y, int width, int height, uint32_t color) {
+	FillRect(x, y, width, 1, color);
+	FillRect(x, y + height - 1, width, 1, color);
+	FillRect(x, y + 1, 1, height - 2, color);
+	FillRect(x + width - 1, y + 1, 1, height - 2, color);
+}
 
-	if (world.bodies[anotherBranch->id]->position.y >= height - world.bodies[anotherBranch->id]->width.y / 2.0f) {
-		world.bodies[anotherBranch->id]->velocity.y = -world.bodies[anotherBranch->id]->velocity.y;
-	} else if (world.bodies[anotherBranch->id]->position.y <= world.bodies[anotherBranch->id]->width.y / 2.0f) {
-		world.bodies[anotherBranch->id]->velocity.y = -world.bodies[anotherBranch->id]->velocity.y;
+void Game::RenderPerfOverlay(const render::RenderSnapshot& snapshot) {
+	const RollingStats& frames = framePacer.getStats();
+	double periodMs = std::chrono::duration<double, std::milli>(framePacer.getPeriod()).count();
+
+	if (perfTextFrames-- <= 0) {
+		char line[64];
+		perfText.clear();
+		std::snprintf(line, sizeof(line), "FPS %.0f  p99 %.1f ms", frames.mean() > 0.0 ? 1000.0 / frames.mean() : 0.0, frames.percentile(0.99));
+		perfText.push_back(line);
+		std::snprintf(line, sizeof(line), "tick %.2f  step %.2f ms", snapshot.tickMs, snapshot.step.totalMs());
+		perfText.push_back(line);
+		std::snprintf(line, sizeof(line), "broad %.2f  pre %.2f", snapshot.step.broadPhaseMs, snapshot.step.preStepMs);
+		perfText.push_back(line);
+		std::snprintf(line, sizeof(line), "solve %.2f  integrate %.2f", snapshot.step.solveMs, snapshot.step.integrateMs);
+		perfText.push_back(line);
+		std::snprintf(line, sizeof(line), "bodies %d  arbiters %d", snapshot.step.bodies, snapshot.step.arbiters);
+		perfText.push_back(line);
+		std::snprintf(line, sizeof(line), "contacts %d  draws %d", snapshot.step.contacts, lastDrawCalls);
+		perfText.push_back(line);
+		std::snprintf(line, sizeof(line), "sprites %d  particles %d", lastSprites, snapshot.liveParticles);
+		perfText.push_back(line);
+		std::snprintf(line, sizeof(line), "allocs tick %u  step %u", snapshot.tickAllocations, snapshot.stepAllocations);
+		perfText.push_back(line);
+		std::snprintf(line, sizeof(line), "audio underruns %d", mixer.getUnderruns());
+		perfText.push_back(line);
+		perfTextFrames = 15;
 	}
 
-	for (auto& arb : world.arbiters) {
-		if ((arb.second.body1->id == character->id && arb.second.body2->id == fruit->id) || (arb.second.body2->id == character->id && arb.second.body1->id == fruit->id)) {
-			score++;
-			ResetGame(false);
-			break;
-		}
+	// One bar per frame time in the window, scaled so two periods fill it
+	const int graphHeight = 80;
+	const int padding = 8;
+	float textWidth = 0.0f;
+	for (const auto& text : perfText) {
+		textWidth = std::max(textWidth, hudFont.layout(text).width);
+	}
+	int panelWidth = std::max(static_cast<int>(RollingStats::CAPACITY), static_cast<int>(textWidth)) + 2 * padding;
+	int lineHeight = static_cast<int>(hudFont.getLineHeight());
+	int panelHeight = graphHeight + static_cast<int>(perfText.size()) * lineHeight + 3 * padding;
+	int x = width - panelWidth - padding;
+	int y = padding;
+
+	FillRect(x, y, panelWidth, panelHeight, render::packColor(0, 0, 0, 160));
+
+	int graphX = x + padding;
+	int graphBottom = y + padding + graphHeight;
+	for (int i = 0; i < frames.count(); ++i) {
+		double ms = frames.at(i);
+		int barHeight = std::min(graphHeight, static_cast<int>(ms / (2.0 * periodMs) * graphHeight));
+		uint32_t color = ms <= periodMs * 1.05 ? render::packColor(80, 220, 80) : ms <= periodMs * 2.05 ? render::packColor(240, 200, 40) : render::packColor(240, 60, 40);
+		FillRect(graphX + i, graphBottom - barHeight, 1, barHeight, color);
+	}
+	// Frame budget
+	FillRect(graphX, graphBottom - graphHeight / 2, RollingStats::CAPACITY, 1, render::packColor(255, 255, 255, 128));
+
+	float textY = static_cast<float>(graphBottom + padding);
+	for (const auto& text : perfText) {
+		hudFont.draw(spriteBatch, atlas, text, static_cast<float>(graphX), textY, render::WHITE);
+		textY += lineHeight;
+	}
+}
+
+void Game::Logic() {
+	AllocationScope stepScope;
+	world.step(tick);
+	stepAllocations = static_cast<uint32_t>(stepScope.allocations());
+	UpdateTransforms();
+	UpdateMovingPlatforms();
+	UpdateEffects();
+
+	int points = CollectPickups();
+	if (points > 0) {
+		score += points;
+		ResetGame(false);
+		// The fruit went with the old level, so the burst greets the player
+		// at the start of the next one
+		const Transform& transform = registry.get<Transform>(player);
+		particles.emit(fx::EFFECT::SPARK, transform.position.x, transform.position.y, 200, rng::stream(RNG_STREAM::PARTICLES));
+		mixer.play(audio::SOUND::PICKUP);
+		return;
 	}
 
 	// World boundaries
+	const Transform& transform = registry.get<Transform>(player);
 	// left-right
-	if (world.bodies[character->id]->position.x <= -world.bodies[character->id]->width.x) {
+	if (transform.position.x <= -transform.size.x) {
 		ResetGame(true);
-	} else if (world.bodies[character->id]->position.x >= width + world.bodies[character->id]->width.x) {
+	} else if (transform.position.x >= level.getWidth() + transform.size.x) {
 		ResetGame(true);
 	}
 	// top-bottom
-	if (world.bodies[character->id]->position.y <= -world.bodies[character->id]->width.y) {
+	if (transform.position.y <= -transform.size.y) {
 		ResetGame(true);
-	} else if (world.bodies[character->id]->position.y >= height + world.bodies[character->id]->width.y) {
+	} else if (transform.position.y >= height + transform.size.y) {
 		ResetGame(true);
 	}
+
+	UpdateCamera();
 }
 
-void Game::RenderScene() {
-	Logic();
-	glClearColor(0.4f, 0.6f, 0.9f, 1.0f);
-	glClear(GL_COLOR_BUFFER_BIT);
+void Game::UpdateTransforms() {
+	registry.each<Transform, PhysicsBody>([](Transform& transform, PhysicsBody& physicsBody) {
+		transform.position = physicsBody.body->position;
+	});
+}
 
-	glMatrixMode(GL_MODELVIEW);
-	glLoadIdentity();
+void Game::UpdateEffects() {
+	Pcg32& random = rng::stream(RNG_STREAM::PARTICLES);
 
-	glEnable(GL_TEXTURE_2D);
+	physics::Body* body = registry.get<PhysicsBody>(player).body;
+	if (body->canJump && !playerGrounded) {
+		particles.emit(fx::EFFECT::DUST, body->position.x, body->position.y + body->width.y / 2.0f, 16, random);
+		PlaySoundAt(audio::SOUND::LAND, body->position.x);
+	}
+	playerGrounded = body->canJump;
 
-	glBindTexture(GL_TEXTURE_2D, backgroundTextureId);
-	glBegin(GL_POLYGON);
-		glTexCoord2f(0.0f, 1.0f);
-		glVertex2f(0.0f, 0.0f);
-		glTexCoord2f(1.0f, 1.0f);
-		glVertex2f(width, 0.0f);
-		glTexCoord2f(1.0f, 0.0f);
-		glVertex2f(width, height);
-		glTexCoord2f(0.0f, 0.0f);
-		glVertex2f(0.0f, height);
-	glEnd();
+	// Leaves appear anywhere in view and fade in, so they don't all have to
+	// fall from the top
+	leavesOwed += LEAVES_PER_SECOND * tick;
+	for (; leavesOwed >= 1.0f; leavesOwed -= 1.0f) {
+		particles.emit(fx::EFFECT::LEAF, cameraX + random.range(0.0f, static_cast<float>(width)), random.range(0.0f, 0.8f * height), 1, random);
+	}
 
-	for (const auto& body : world.bodies) {
-		glBindTexture(GL_TEXTURE_2D, body->textureId);
+	particles.update(tick);
+}
 
-		glBegin(GL_POLYGON);
-			glTexCoord2f(0.0f, 1.0f);
-			glVertex2f(body->position.x - body->width.x / 2.0f, body->position.y - body->width.y / 2.0f);
-			glTexCoord2f(1.0f, 1.0f);
-			glVertex2f(body->position.x + body->width.x / 2.0f, body->position.y - body->width.y / 2.0f);
-			glTexCoord2f(1.0f, 0.0f);
-			glVertex2f(body->position.x + body->width.x / 2.0f, body->position.y + body->width.y / 2.0f);
-			glTexCoord2f(0.0f, 0.0f);
-			glVertex2f(body->position.x - body->width.x / 2.0f, body->position.y + body->width.y / 2.0f);
-		glEnd();
+void Game::PlaySoundAt(audio::SOUND sound, float x) {
+	// Panned by where on screen the sound comes from
+	float pan = (x - cameraX) / width * 2.0f - 1.0f;
+	mixer.play(sound, 1.0f, pan);
+}
 
-		glBindTexture(GL_TEXTURE_2D, 0);
-	}
+void Game::UpdateMovingPlatforms() {
+	registry.each<PhysicsBody, MovingPlatform>([](PhysicsBody& physicsBody, MovingPlatform& platform) {
+		physics::Body* body = physicsBody.body;
+		if (body->position.y >= platform.maxY) {
+			body->velocity.y = -body->velocity.y;
+		} else if (body->position.y <= platform.minY) {
+			body->velocity.y = -body->velocity.y;
+		}
+	});
+}
 
-	glDisable(GL_TEXTURE_2D);
+int Game::CollectPickups() {
+	physics::Body* playerBody = registry.get<PhysicsBody>(player).body;
+
+	int points = 0;
+	registry.each<PhysicsBody, Pickup>([&](PhysicsBody& physicsBody, Pickup& pickup) {
+		// Arbiters only exist while the bodies touch
+		if (world.arbiters.count(physics::ArbiterKey(playerBody, physicsBody.body))) {
+			points += pickup.points;
+		}
+	});
+	return points;
 }
 
+void Game::RenderScene(const render::RenderSnapshot& snapshot) {
+	sceneRenderer.draw(snapshot);
+
+	hudFont.draw(spriteBatch, atlas, "Score: " + std::to_string(snapshot.score), 16.0f, 8.0f, render::WHITE);
+}
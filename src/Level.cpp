@@ -0,0 +1,211 @@
+#include "../include/Level.hpp"
+#include <algorithm>
+#include <cmath>
+
+Level::Level() {
+	screenWidth = 0;
+	screenHeight = 0;
+	treeSprite = -1;
+	branchSprite = -1;
+	fruitSprite = -1;
+	vineSprite = -1;
+
+	data = nullptr;
+	scaleX = 1.0f;
+	scaleY = 1.0f;
+	seed = 0;
+	score = 0;
+}
+
+void Level::configure(int screenWidth, int screenHeight, int treeSprite, int branchSprite, int fruitSprite, int vineSprite) {
+	this->screenWidth = screenWidth;
+	this->screenHeight = screenHeight;
+	this->treeSprite = treeSprite;
+	this->branchSprite = branchSprite;
+	this->fruitSprite = fruitSprite;
+	this->vineSprite = vineSprite;
+}
+
+void Level::reset(const LevelData& data, uint64_t seed, int score) {
+	this->data = &data;
+	this->seed = seed;
+	this->score = score;
+	scaleX = screenWidth / data.getHeader().screenWidth;
+	scaleY = screenHeight / data.getHeader().screenHeight;
+}
+
+float Level::getWidth() const {
+	return data->getHeader().width * scaleX;
+}
+
+physics::Vec2 Level::getSpawn(const physics::Vec2& size) const {
+	const LevelHeader& header = data->getHeader();
+	return physics::Vec2(header.spawnX * scaleX, header.spawnY * scaleY - size.y / 2.0f);
+}
+
+int Level::chunkAt(float x) const {
+	return static_cast<int>(std::floor(x / (data->getHeader().chunkWidth * scaleX)));
+}
+
+bool Level::isLoaded(int index) const {
+	for (const auto& chunk : chunks) {
+		if (chunk.index == index) {
+			return true;
+		}
+	}
+	return false;
+}
+
+bool Level::stream(physics::World& world, ecs::Registry& registry, float x0, float x1) {
+	int first = std::max(chunkAt(x0), 0);
+	int last = std::min(chunkAt(x1), static_cast<int>(data->getHeader().chunkCount) - 1);
+	bool changed = false;
+
+	for (auto iter = chunks.begin(); iter != chunks.end();) {
+		if (iter->index < first || iter->index > last) {
+			evict(world, registry, *iter);
+			iter = chunks.erase(iter);
+			changed = true;
+		} else {
+			++iter;
+		}
+	}
+
+	for (int index = first; index <= last; ++index) {
+		if (!isLoaded(index)) {
+			load(world, registry, index);
+			changed = true;
+		}
+	}
+
+	return changed;
+}
+
+void Level::unload(physics::World& world, ecs::Registry& registry) {
+	for (auto& chunk : chunks) {
+		evict(world, registry, chunk);
+	}
+	chunks.clear();
+}
+
+void Level::evict(physics::World& world, ecs::Registry& registry, LevelChunk& chunk) {
+	for (auto entity : chunk.entities) {
+		registry.destroy(entity);
+	}
+	for (auto& rope : chunk.ropes) {
+		world.remove(&rope);
+	}
+	for (auto& body : chunk.bodies) {
+		world.remove(&body);
+	}
+}
+
+float Level::movingSpeed(const LevelBody& source, uint32_t index) const {
+	// Each moving branch draws from a stream of its own, the range widening
+	// with the score like the single screen level did
+	Pcg32 random(seed, index);
+	return random.range(static_cast<int>(source.speedMin * ((score / 2.0f) + 1)), static_cast<int>(source.speedMax * ((score / 4.0f) + 1)));
+}
+
+int Level::vineSegments(const LevelBody& source) const {
+	// Segments half again as long as the vine is thick
+	float segmentLength = 1.5f * source.width * scaleX;
+	return std::max(static_cast<int>(std::lround(source.height * scaleY / segmentLength)), 1);
+}
+
+void Level::load(physics::World& world, ecs::Registry& registry, int index) {
+	const LevelChunkRange& range = data->getChunks()[index];
+	int bodyCount = 0;
+	int ropeCount = 0;
+	for (uint32_t i = 0; i < range.bodyCount; ++i) {
+		const LevelBody& source = data->getBodies()[range.firstBody + i];
+		if (source.kind == LEVEL_BODY::VINE) {
+			bodyCount += vineSegments(source);
+			++ropeCount;
+		} else {
+			++bodyCount;
+		}
+	}
+
+	chunks.push_back(LevelChunk{ index, std::vector<physics::Body>(bodyCount), {}, {} });
+	LevelChunk& chunk = chunks.back();
+	chunk.ropes.reserve(ropeCount);
+	chunk.entities.reserve(bodyCount);
+
+	int next = 0;
+	for (uint32_t i = 0; i < range.bodyCount; ++i) {
+		const LevelBody& source = data->getBodies()[range.firstBody + i];
+		if (source.kind == LEVEL_BODY::VINE) {
+			loadVine(registry, chunk, source, range.firstBody + i, next);
+			continue;
+		}
+
+		physics::Body& body = chunk.bodies[next++];
+		if (source.kind == LEVEL_BODY::FRUIT) {
+			// Contacts turn bodies, but the fruit sprite doesn't roll
+			body.fixedRotation = true;
+			body.set(physics::Vec2(source.width * scaleX, source.height * scaleY), 0.01f, physics::SHAPE::CIRCLE);
+		} else {
+			body.set(physics::Vec2(source.width * scaleX, source.height * scaleY), FLT_MAX);
+		}
+		body.position.set(source.x * scaleX, source.y * scaleY);
+		Transform transform{ body.position, body.width };
+
+		ecs::Entity entity;
+		switch (source.kind) {
+		case LEVEL_BODY::TREE:
+			body.friction = 0;
+			entity = registry.create(transform, PhysicsBody{ &body }, Sprite{ treeSprite, SPRITE_LAYER::STATIC });
+			break;
+		case LEVEL_BODY::BRANCH:
+			entity = registry.create(transform, PhysicsBody{ &body }, Sprite{ branchSprite, SPRITE_LAYER::STATIC });
+			break;
+		case LEVEL_BODY::MOVING_BRANCH:
+			body.velocity.y = movingSpeed(source, range.firstBody + i);
+			entity = registry.create(transform, PhysicsBody{ &body }, Sprite{ branchSprite, SPRITE_LAYER::DYNAMIC }, MovingPlatform{ body.width.y / 2.0f, screenHeight - body.width.y / 2.0f });
+			break;
+		case LEVEL_BODY::FRUIT:
+			entity = registry.create(transform, PhysicsBody{ &body }, Sprite{ fruitSprite, SPRITE_LAYER::DYNAMIC }, Pickup{ 1 });
+			break;
+		case LEVEL_BODY::VINE:
+			break;
+		}
+		chunk.entities.push_back(entity);
+	}
+
+	world.add(chunk.bodies.data(), static_cast<int>(chunk.bodies.size()));
+	for (auto& rope : chunk.ropes) {
+		world.add(&rope);
+	}
+}
+
+void Level::loadVine(ecs::Registry& registry, LevelChunk& chunk, const LevelBody& source, uint32_t index, int& next) {
+	int segments = vineSegments(source);
+	float thickness = source.width * scaleX;
+	float segmentLength = source.height * scaleY / segments;
+	physics::Vec2 top(source.x * scaleX, source.y * scaleY);
+
+	// Capsule segments joined end to end, hanging straight down. They share
+	// a group so neighbours don't collide where their caps overlap.
+	chunk.ropes.emplace_back();
+	physics::Rope& rope = chunk.ropes.back();
+	physics::Body* previous = nullptr;
+	for (int i = 0; i < segments; ++i) {
+		physics::Body& body = chunk.bodies[next++];
+		body.set(physics::Vec2(thickness, segmentLength), 0.001f, physics::SHAPE::CAPSULE);
+		body.position.set(top.x, top.y + (i + 0.5f) * segmentLength);
+		body.group = static_cast<int>(index) + 1;
+
+		physics::Vec2 anchor(top.x, top.y + i * segmentLength);
+		if (previous == nullptr) {
+			rope.pin(&body, anchor);
+		} else {
+			rope.link(previous, &body, anchor);
+		}
+		previous = &body;
+
+		// Drawn as a bead per segment, the sprite doesn't turn with it
+		Transform transform{ body.position, physics::Vec2(segmentLength, segmentLength) };
+		chunk.entities.push_back(registry.create(transform, PhysicsBody{ &body }, Sprite{ vineSprite, SPRITE_LAYER::DYNAMIC }));
+	}
+}
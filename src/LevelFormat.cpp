@@ -0,0 +1,175 @@
+#include "../include/LevelFormat.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <sstream>
+
+namespace {
+
+const char MAGIC[4] = { 'J', 'W', 'L', 'V' };
+
+bool fail(std::string& error, int line, const std::string& message) {
+	error = "line " + std::to_string(line) + ": " + message;
+	return false;
+}
+
+}
+
+bool compileLevel(const std::string& text, std::vector<uint8_t>& blob, std::string& error) {
+	LevelHeader header;
+	std::memset(&header, 0, sizeof(header));
+	std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+	header.version = LevelData::VERSION;
+
+	bool hasScreen = false;
+	bool hasSpawn = false;
+	int fruitCount = 0;
+	std::vector<LevelBody> bodies;
+
+	std::istringstream lines(text);
+	std::string line;
+	int lineNumber = 0;
+	while (std::getline(lines, line)) {
+		++lineNumber;
+		line = line.substr(0, line.find('#'));
+
+		std::istringstream fields(line);
+		std::string directive;
+		if (!(fields >> directive)) {
+			continue;
+		}
+
+		float values[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		int expected = 2;
+		if (directive == "width" || directive == "chunk" || directive == "tree") {
+			expected = 1;
+		} else if (directive == "vine") {
+			expected = 3;
+		} else if (directive == "moving") {
+			expected = 4;
+		} else if (directive != "screen" && directive != "spawn" && directive != "branch" && directive != "fruit") {
+			return fail(error, lineNumber, "unknown directive '" + directive + "'");
+		}
+
+		for (int i = 0; i < expected; ++i) {
+			if (!(fields >> values[i]) || !std::isfinite(values[i])) {
+				return fail(error, lineNumber, "'" + directive + "' takes " + std::to_string(expected) + " numbers");
+			}
+		}
+		std::string extra;
+		if (fields >> extra) {
+			return fail(error, lineNumber, "unexpected '" + extra + "'");
+		}
+
+		// Bodies take their sizes from the screen, like the original single
+		// screen level did
+		float treeWidth = header.screenWidth / 12.5f;
+		float branchHeight = header.screenHeight / 20.0f;
+		float fruitSize = 1.9f * branchHeight;
+		float vineWidth = branchHeight / 3.0f;
+
+		if (directive == "screen") {
+			if (values[0] <= 0.0f || values[1] <= 0.0f) {
+				return fail(error, lineNumber, "screen size must be positive");
+			}
+			header.screenWidth = values[0];
+			header.screenHeight = values[1];
+			hasScreen = true;
+		} else if (!hasScreen) {
+			return fail(error, lineNumber, "'screen' must come first");
+		} else if (directive == "width") {
+			header.width = values[0];
+		} else if (directive == "chunk") {
+			header.chunkWidth = values[0];
+		} else if (directive == "spawn") {
+			header.spawnX = values[0];
+			header.spawnY = values[1];
+			hasSpawn = true;
+		} else if (directive == "tree") {
+			bodies.push_back(LevelBody{ LEVEL_BODY::TREE, values[0], header.screenHeight / 2.0f, treeWidth, header.screenHeight, 0.0f, 0.0f });
+		} else if (directive == "branch") {
+			bodies.push_back(LevelBody{ LEVEL_BODY::BRANCH, values[0], values[1], 2.0f * treeWidth, branchHeight, 0.0f, 0.0f });
+		} else if (directive == "moving") {
+			if (values[2] > values[3]) {
+				return fail(error, lineNumber, "speed range is backwards");
+			}
+			bodies.push_back(LevelBody{ LEVEL_BODY::MOVING_BRANCH, values[0], values[1], 2.0f * treeWidth, branchHeight, values[2], values[3] });
+		} else if (directive == "fruit") {
+			bodies.push_back(LevelBody{ LEVEL_BODY::FRUIT, values[0], values[1] - fruitSize / 2.0f, fruitSize, fruitSize, 0.0f, 0.0f });
+			++fruitCount;
+		} else if (directive == "vine") {
+			if (values[2] <= 0.0f) {
+				return fail(error, lineNumber, "vine length must be positive");
+			}
+			bodies.push_back(LevelBody{ LEVEL_BODY::VINE, values[0], values[1], vineWidth, values[2], 0.0f, 0.0f });
+		}
+	}
+
+	if (!hasScreen || !hasSpawn || header.width <= 0.0f || header.chunkWidth <= 0.0f) {
+		return fail(error, lineNumber, "'screen', 'spawn', 'width' and 'chunk' are required");
+	}
+	if (fruitCount == 0) {
+		return fail(error, lineNumber, "a level needs a fruit to finish it");
+	}
+
+	// Bodies belong to the chunk their center is in
+	header.chunkCount = static_cast<uint32_t>(std::ceil(header.width / header.chunkWidth));
+	auto chunkOf = [&header](const LevelBody& body) {
+		int chunk = static_cast<int>(std::floor(body.x / header.chunkWidth));
+		return std::min(std::max(chunk, 0), static_cast<int>(header.chunkCount) - 1);
+	};
+	std::stable_sort(bodies.begin(), bodies.end(), [&chunkOf](const LevelBody& a, const LevelBody& b) {
+		return chunkOf(a) < chunkOf(b);
+	});
+
+	std::vector<LevelChunkRange> chunks(header.chunkCount, LevelChunkRange{ 0, 0 });
+	for (uint32_t i = 0; i < bodies.size(); ++i) {
+		LevelChunkRange& chunk = chunks[chunkOf(bodies[i])];
+		if (chunk.bodyCount == 0) {
+			chunk.firstBody = i;
+		}
+		++chunk.bodyCount;
+	}
+	header.bodyCount = static_cast<uint32_t>(bodies.size());
+
+	blob.resize(sizeof(LevelHeader) + chunks.size() * sizeof(LevelChunkRange) + bodies.size() * sizeof(LevelBody));
+	uint8_t* out = blob.data();
+	std::memcpy(out, &header, sizeof(header));
+	out += sizeof(header);
+	std::memcpy(out, chunks.data(), chunks.size() * sizeof(LevelChunkRange));
+	out += chunks.size() * sizeof(LevelChunkRange);
+	std::memcpy(out, bodies.data(), bodies.size() * sizeof(LevelBody));
+
+	return true;
+}
+
+LevelData::LevelData() {
+	header = nullptr;
+	chunks = nullptr;
+	bodies = nullptr;
+}
+
+bool LevelData::view(const uint8_t* data, size_t size) {
+	header = nullptr;
+	if (size < sizeof(LevelHeader) || reinterpret_cast<uintptr_t>(data) % alignof(LevelHeader) != 0) {
+		return false;
+	}
+
+	const LevelHeader* candidate = reinterpret_cast<const LevelHeader*>(data);
+	if (std::memcmp(candidate->magic, MAGIC, sizeof(MAGIC)) != 0 || candidate->version != VERSION || candidate->chunkCount == 0
+		|| size != sizeof(LevelHeader) + static_cast<uint64_t>(candidate->chunkCount) * sizeof(LevelChunkRange) + static_cast<uint64_t>(candidate->bodyCount) * sizeof(LevelBody)) {
+		return false;
+	}
+
+	const LevelChunkRange* ranges = reinterpret_cast<const LevelChunkRange*>(data + sizeof(LevelHeader));
+	for (uint32_t i = 0; i < candidate->chunkCount; ++i) {
+		if (static_cast<uint64_t>(ranges[i].firstBody) + ranges[i].bodyCount > candidate->bodyCount) {
+			return false;
+		}
+	}
+
+	header = candidate;
+	chunks = ranges;
+	bodies = reinterpret_cast<const LevelBody*>(data + sizeof(LevelHeader) + candidate->chunkCount * sizeof(LevelChunkRange));
+	return true;
+}
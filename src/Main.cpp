@@ -1,7 +1,25 @@
 #include "../include/Game.hpp"
+#include "../include/utils/Random.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 
-int main(int, char**) {
+int main(int argc, char** argv) {
 	Game game{1280, 720};
 
+	// --record <file> saves the session's movement input, e.g. as training
+	// data for tools/pgo.sh. --seed <n> fixes the random seed, so levels and
+	// effects come out the same as in an earlier run.
+	for (int i = 1; i + 1 < argc; ++i) {
+		if (std::strcmp(argv[i], "--record") == 0) {
+			game.RecordInput(argv[i + 1]);
+		} else if (std::strcmp(argv[i], "--seed") == 0) {
+			rng::setSeed(std::strtoull(argv[i + 1], nullptr, 0));
+		}
+	}
+
+	// Printed either way, so a run with an OS-drawn seed can be repeated
+	std::printf("Random seed %llu\n", static_cast<unsigned long long>(rng::getSeed()));
+
 	return game.OnExecute();
 }
@@ -1,26 +1,29 @@
 #include "../include/Utils.hpp"
-#include <random>
 
 float randomFloat(float min, float max) {
-	std::random_device rd;
-	std::mt19937 gen(rd());
-	std::uniform_real_distribution<float> dist(min, max);
-
-	return dist(gen);
+	return rng::stream(RNG_STREAM::LEVEL).range(min, max);
 }
 
 int randomInt(int min, int max) {
-	std::random_device rd;
-	std::mt19937 gen(rd());
-	std::uniform_int_distribution<int> dist(min, max);
-
-	return dist(gen);
+	return rng::stream(RNG_STREAM::LEVEL).range(min, max);
 }
 
 float newVel(int x) {
+#ifdef JUNGLE_WAYS_DETERMINISTIC
+	// exp(-0.05 x) by squaring, since std::exp differs between C libraries
+	double decay = 1.0;
+	double factor = 0.95122942450071402;
+	for (int n = x < 0 ? -x : x; n > 0; n >>= 1) {
+		if (n & 1) {
+			decay *= factor;
+		}
+		factor *= factor;
+	}
+	if (x < 0) {
+		decay = 1.0 / decay;
+	}
+	return 60 * (1 - decay) + 20;
+#else
 	return 60 * (1 - std::exp(-0.05*x)) + 20;
-}
-
-void loadTextureIntoBody(physics::Body& body, GLuint textureId) {
-    body.applyTexture(textureId);
+#endif
 }
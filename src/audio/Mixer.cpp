@@ -0,0 +1,225 @@
+#include "../../include/audio/Mixer.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace audio {
+
+namespace {
+
+const float TWO_PI = 6.28318531f;
+// Per sample step of the fades, about 20ms from silence to full
+const float FADE_RATE = 0.001f;
+
+const float WIND_GAIN = 0.12f;
+const float BIRD_GAIN = 0.08f;
+const float MUSIC_GAIN = 0.35f;
+const float NOTE_SECONDS = 0.07f;
+
+float approach(float value, float target) {
+	return value + (target - value) * FADE_RATE;
+}
+
+}
+
+Mixer::Mixer() : music(new MusicStream()), ambientOn(true), musicOn(true), underruns(0) {
+	device = 0;
+	sampleRate = 48000;
+
+	for (auto& voice : voices) {
+		voice.sound = nullptr;
+		voice.position = 0;
+		voice.left = 0.0f;
+		voice.right = 0.0f;
+	}
+	ambientGain = 0.0f;
+	musicGain = 0.0f;
+	noise.seed(0x6a756e676c65ULL, 7);
+	wind = 0.0f;
+	gustPhase = 0.0f;
+	untilCall = 0;
+	notesLeft = 0;
+	notePosition = 0;
+	notePhase = 0.0f;
+	noteFrequency = 0.0f;
+	notePan = 0.0f;
+}
+
+Mixer::~Mixer() {
+	close();
+}
+
+bool Mixer::open(const std::string& musicFile) {
+	SDL_AudioSpec wanted;
+	SDL_zero(wanted);
+	wanted.freq = 48000;
+	wanted.format = AUDIO_F32SYS;
+	wanted.channels = 2;
+	wanted.samples = BUFFER_FRAMES;
+	wanted.callback = &Mixer::callback;
+	wanted.userdata = this;
+
+	SDL_AudioSpec obtained;
+	device = SDL_OpenAudioDevice(nullptr, 0, &wanted, &obtained, SDL_AUDIO_ALLOW_FREQUENCY_CHANGE);
+	if (device == 0) {
+		return false;
+	}
+	sampleRate = obtained.freq;
+
+	// Everything the callback reads exists before it first runs
+	for (int i = 0; i < static_cast<int>(SOUND::COUNT); ++i) {
+		sounds[i] = synthesize(static_cast<SOUND>(i), sampleRate);
+	}
+	untilCall = sampleRate;
+	if (!musicFile.empty()) {
+		music->start(musicFile, sampleRate);
+	}
+
+	SDL_PauseAudioDevice(device, 0);
+	return true;
+}
+
+void Mixer::close() {
+	if (device != 0) {
+		// Returns once the callback has finished for good
+		SDL_CloseAudioDevice(device);
+		device = 0;
+	}
+	music->stop();
+}
+
+void Mixer::play(SOUND sound, float gain, float pan) {
+	if (device != 0) {
+		commands.push(AudioCommand{ sound, gain, pan });
+	}
+}
+
+void Mixer::callback(void* userdata, Uint8* stream, int length) {
+	static_cast<Mixer*>(userdata)->mix(reinterpret_cast<float*>(stream), length / static_cast<int>(2 * sizeof(float)));
+}
+
+void Mixer::mix(float* out, int frames) {
+	std::fill(out, out + 2 * frames, 0.0f);
+
+	AudioCommand command;
+	while (commands.pop(command)) {
+		startVoice(command);
+	}
+
+	for (auto& voice : voices) {
+		if (voice.sound == nullptr) {
+			continue;
+		}
+
+		const std::vector<float>& samples = voice.sound->samples;
+		int count = static_cast<int>(std::min(samples.size() - voice.position, static_cast<size_t>(frames)));
+		for (int i = 0; i < count; ++i) {
+			float sample = samples[voice.position + i];
+			out[2 * i] += sample * voice.left;
+			out[2 * i + 1] += sample * voice.right;
+		}
+		voice.position += count;
+		if (voice.position >= samples.size()) {
+			voice.sound = nullptr;
+		}
+	}
+
+	mixAmbient(out, frames);
+	mixMusic(out, frames);
+
+	for (int i = 0; i < 2 * frames; ++i) {
+		out[i] = std::min(std::max(out[i], -1.0f), 1.0f);
+	}
+}
+
+void Mixer::startVoice(const AudioCommand& command) {
+	// A free voice, or else the one closest to finishing
+	Voice* chosen = &voices[0];
+	for (auto& voice : voices) {
+		if (voice.sound == nullptr) {
+			chosen = &voice;
+			break;
+		}
+		if (voice.sound->samples.size() - voice.position < chosen->sound->samples.size() - chosen->position) {
+			chosen = &voice;
+		}
+	}
+
+	// Constant power panning
+	float angle = (std::min(std::max(command.pan, -1.0f), 1.0f) + 1.0f) * TWO_PI / 8.0f;
+	chosen->sound = &sounds[static_cast<int>(command.sound)];
+	chosen->position = 0;
+	chosen->left = command.gain * std::cos(angle);
+	chosen->right = command.gain * std::sin(angle);
+}
+
+void Mixer::mixAmbient(float* out, int frames) {
+	float target = ambientOn ? 1.0f : 0.0f;
+	if (target == 0.0f && ambientGain < 1e-4f) {
+		ambientGain = 0.0f;
+		return;
+	}
+
+	float gustStep = TWO_PI * 0.07f / sampleRate;
+	int noteLength = static_cast<int>(NOTE_SECONDS * sampleRate);
+	for (int i = 0; i < frames; ++i) {
+		ambientGain = approach(ambientGain, target);
+
+		// Wind: low passed noise swelling in slow gusts
+		wind += 0.02f * (noise.range(-1.0f, 1.0f) - wind);
+		gustPhase += gustStep;
+		if (gustPhase > TWO_PI) {
+			gustPhase -= TWO_PI;
+		}
+		float gust = 0.6f + 0.4f * std::sin(gustPhase);
+		float left = WIND_GAIN * gust * wind;
+		float right = left;
+
+		// Birds
+		if (notesLeft == 0 && --untilCall <= 0) {
+			notesLeft = 2 + static_cast<int>(noise.next() % 3);
+			notePosition = 0;
+			noteFrequency = noise.range(2200.0f, 3200.0f);
+			notePan = noise.range(-0.8f, 0.8f);
+			untilCall = static_cast<int>(noise.range(1.5f, 5.0f) * sampleRate);
+		}
+		if (notesLeft > 0) {
+			float t = static_cast<float>(notePosition) / noteLength;
+			notePhase += TWO_PI * noteFrequency * (1.0f + 0.4f * t) / sampleRate;
+			if (notePhase > TWO_PI) {
+				notePhase -= TWO_PI;
+			}
+			float note = BIRD_GAIN * std::sin(TWO_PI * 0.5f * t) * std::sin(notePhase);
+			left += note * (1.0f - notePan) * 0.5f;
+			right += note * (1.0f + notePan) * 0.5f;
+			if (++notePosition >= noteLength) {
+				notePosition = 0;
+				--notesLeft;
+			}
+		}
+
+		out[2 * i] += ambientGain * left;
+		out[2 * i + 1] += ambientGain * right;
+	}
+}
+
+void Mixer::mixMusic(float* out, int frames) {
+	float target = musicOn ? 1.0f : 0.0f;
+	if (!music->isPlaying() || (target == 0.0f && musicGain < 1e-4f)) {
+		musicGain = 0.0f;
+		return;
+	}
+
+	StereoFrame frame;
+	for (int i = 0; i < frames; ++i) {
+		if (!music->pop(frame)) {
+			// Out of decoded music: play on in silence rather than wait
+			++underruns;
+			return;
+		}
+		musicGain = approach(musicGain, target);
+		out[2 * i] += MUSIC_GAIN * musicGain * frame.left;
+		out[2 * i + 1] += MUSIC_GAIN * musicGain * frame.right;
+	}
+}
+
+}
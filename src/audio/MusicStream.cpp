@@ -0,0 +1,182 @@
+#include "../../include/audio/MusicStream.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+namespace audio {
+
+namespace {
+
+// Source frames decoded per block
+const int BLOCK_FRAMES = 4096;
+
+struct WavFormat {
+	int channels;
+	int sampleRate;
+	int bits;
+	std::streamoff dataStart;
+	uint32_t dataBytes;
+};
+
+uint32_t readLittle(std::ifstream& file, int bytes) {
+	uint8_t buffer[4] = { 0, 0, 0, 0 };
+	file.read(reinterpret_cast<char*>(buffer), bytes);
+	return buffer[0] | (buffer[1] << 8) | (buffer[2] << 16) | (static_cast<uint32_t>(buffer[3]) << 24);
+}
+
+bool readHeader(std::ifstream& file, WavFormat& format) {
+	char riff[4];
+	char wave[4];
+	file.read(riff, 4);
+	readLittle(file, 4);
+	file.read(wave, 4);
+	if (!file || std::memcmp(riff, "RIFF", 4) != 0 || std::memcmp(wave, "WAVE", 4) != 0) {
+		return false;
+	}
+
+	bool hasFormat = false;
+	while (file) {
+		char id[4];
+		file.read(id, 4);
+		uint32_t size = readLittle(file, 4);
+		if (!file) {
+			return false;
+		}
+
+		if (std::memcmp(id, "fmt ", 4) == 0 && size >= 16) {
+			int encoding = readLittle(file, 2);
+			format.channels = readLittle(file, 2);
+			format.sampleRate = readLittle(file, 4);
+			readLittle(file, 4);
+			readLittle(file, 2);
+			format.bits = readLittle(file, 2);
+			file.seekg(size - 16 + (size & 1), std::ios::cur);
+			hasFormat = encoding == 1 && (format.channels == 1 || format.channels == 2) && (format.bits == 8 || format.bits == 16) && format.sampleRate > 0;
+		} else if (std::memcmp(id, "data", 4) == 0) {
+			format.dataStart = file.tellg();
+			format.dataBytes = size;
+			return hasFormat && size >= static_cast<uint32_t>(format.channels * format.bits / 8);
+		} else {
+			file.seekg(size + (size & 1), std::ios::cur);
+		}
+	}
+	return false;
+}
+
+float readSample(const uint8_t* data, int bits) {
+	if (bits == 8) {
+		return (data[0] - 128) / 128.0f;
+	}
+	return static_cast<int16_t>(data[0] | (data[1] << 8)) / 32768.0f;
+}
+
+}
+
+MusicStream::MusicStream() : running(false), playing(false) {}
+
+MusicStream::~MusicStream() {
+	stop();
+}
+
+bool MusicStream::start(const std::string& fileName, int sampleRate) {
+	stop();
+
+	std::ifstream file(fileName, std::ios::binary);
+	WavFormat format;
+	if (!file || !readHeader(file, format)) {
+		return false;
+	}
+
+	running = true;
+	playing = true;
+	decoder = std::thread(&MusicStream::decode, this, fileName, sampleRate);
+	return true;
+}
+
+void MusicStream::stop() {
+	running = false;
+	if (decoder.joinable()) {
+		decoder.join();
+	}
+	playing = false;
+}
+
+void MusicStream::decode(std::string fileName, int sampleRate) {
+	decodeFile(fileName, sampleRate);
+	playing = false;
+}
+
+void MusicStream::decodeFile(const std::string& fileName, int sampleRate) {
+	std::ifstream file(fileName, std::ios::binary);
+	WavFormat format;
+	if (!readHeader(file, format)) {
+		return;
+	}
+
+	int bytesPerSample = format.bits / 8;
+	int frameBytes = bytesPerSample * format.channels;
+	std::vector<uint8_t> block(BLOCK_FRAMES * frameBytes);
+	// One frame carried over from the previous block to interpolate across
+	std::vector<StereoFrame> source(BLOCK_FRAMES + 1, StereoFrame{ 0.0f, 0.0f });
+	double step = static_cast<double>(format.sampleRate) / sampleRate;
+	double position = 0.0;
+	uint32_t remaining = format.dataBytes;
+	bool rewound = false;
+
+	while (running) {
+		if (remaining < static_cast<uint32_t>(frameBytes)) {
+			// Loop the track
+			file.clear();
+			file.seekg(format.dataStart);
+			remaining = format.dataBytes;
+			rewound = true;
+		}
+
+		uint32_t bytes = std::min(static_cast<uint32_t>(block.size()), remaining - remaining % frameBytes);
+		file.read(reinterpret_cast<char*>(block.data()), bytes);
+		int frames = static_cast<int>(file.gcount()) / frameBytes;
+		remaining -= bytes;
+		if (frames == 0) {
+			// Nothing even right after a rewind: the file was cut short or
+			// can't be read any more
+			if (rewound) {
+				return;
+			}
+			remaining = 0;
+			continue;
+		}
+		rewound = false;
+
+		for (int i = 0; i < frames; ++i) {
+			const uint8_t* data = block.data() + i * frameBytes;
+			float left = readSample(data, format.bits);
+			float right = format.channels == 2 ? readSample(data + bytesPerSample, format.bits) : left;
+			source[i + 1] = StereoFrame{ left, right };
+		}
+
+		// Linear resampling to the device rate
+		for (; position < frames; position += step) {
+			int index = static_cast<int>(position);
+			float t = static_cast<float>(position - index);
+			const StereoFrame& a = source[index];
+			const StereoFrame& b = source[index + 1];
+			StereoFrame frame{ a.left + (b.left - a.left) * t, a.right + (b.right - a.right) * t };
+
+			// A full ring is the normal state, there is nothing to do until
+			// the mixer has played some of it
+			while (!ring.push(frame)) {
+				if (!running) {
+					return;
+				}
+				std::this_thread::sleep_for(std::chrono::milliseconds(5));
+			}
+		}
+		position -= frames;
+		source[0] = source[frames];
+	}
+}
+
+}
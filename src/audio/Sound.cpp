@@ -0,0 +1,53 @@
+#include "../../include/audio/Sound.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace audio {
+
+namespace {
+
+const float TWO_PI = 6.28318531f;
+
+// Sine sweeping exponentially from one frequency to another, with a fast
+// attack and an exponential decay
+void sweep(std::vector<float>& out, int sampleRate, float start, float seconds, float fromHz, float toHz, float gain) {
+	int first = static_cast<int>(start * sampleRate);
+	int count = static_cast<int>(seconds * sampleRate);
+	if (out.size() < static_cast<size_t>(first + count)) {
+		out.resize(first + count, 0.0f);
+	}
+
+	float phase = 0.0f;
+	for (int i = 0; i < count; ++i) {
+		float t = static_cast<float>(i) / count;
+		float frequency = fromHz * std::pow(toHz / fromHz, t);
+		phase += TWO_PI * frequency / sampleRate;
+		float envelope = std::min(i / (0.005f * sampleRate), 1.0f) * std::exp(-4.0f * t);
+		out[first + i] += gain * envelope * std::sin(phase);
+	}
+}
+
+}
+
+Sound synthesize(SOUND sound, int sampleRate) {
+	Sound result;
+	switch (sound) {
+	case SOUND::JUMP:
+		sweep(result.samples, sampleRate, 0.0f, 0.18f, 300.0f, 900.0f, 0.5f);
+		break;
+	case SOUND::LAND:
+		sweep(result.samples, sampleRate, 0.0f, 0.12f, 160.0f, 60.0f, 0.6f);
+		break;
+	case SOUND::PICKUP:
+		// Rising arpeggio
+		sweep(result.samples, sampleRate, 0.0f, 0.15f, 880.0f, 880.0f, 0.35f);
+		sweep(result.samples, sampleRate, 0.08f, 0.15f, 1108.7f, 1108.7f, 0.35f);
+		sweep(result.samples, sampleRate, 0.16f, 0.30f, 1318.5f, 1318.5f, 0.35f);
+		break;
+	case SOUND::COUNT:
+		break;
+	}
+	return result;
+}
+
+}
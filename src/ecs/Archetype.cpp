@@ -0,0 +1,87 @@
+#include "../../include/ecs/Archetype.hpp"
+#include <cstring>
+#include <utility>
+
+namespace ecs {
+
+namespace {
+
+size_t alignUp(size_t value, size_t alignment) {
+	return (value + alignment - 1) / alignment * alignment;
+}
+
+}
+
+Archetype::Archetype(Signature signature, std::vector<ComponentInfo> components) {
+	this->signature = signature;
+	this->components = std::move(components);
+
+	size_t rowSize = sizeof(Entity);
+	for (const auto& component : this->components) {
+		rowSize += component.size;
+	}
+
+	// Entity handles first, then one array per component. Shrink until the
+	// alignment padding fits too.
+	for (capacity = CHUNK_BYTES / rowSize; capacity > 1; --capacity) {
+		size_t offset = capacity * sizeof(Entity);
+		for (const auto& component : this->components) {
+			offset = alignUp(offset, component.alignment) + capacity * component.size;
+		}
+		if (offset <= CHUNK_BYTES) {
+			break;
+		}
+	}
+
+	for (auto& offset : offsets) {
+		offset = 0;
+	}
+	size_t offset = capacity * sizeof(Entity);
+	for (const auto& component : this->components) {
+		offset = alignUp(offset, component.alignment);
+		offsets[component.id] = offset;
+		offset += capacity * component.size;
+	}
+}
+
+void Archetype::add(Entity entity, int& chunk, int& row) {
+	if (chunks.empty() || chunks.back().count == capacity) {
+		std::unique_ptr<uint8_t[]> data = spare ? std::move(spare) : std::unique_ptr<uint8_t[]>(new uint8_t[CHUNK_BYTES]);
+		chunks.push_back(Chunk{ std::move(data), 0 });
+	}
+
+	Chunk& target = chunks.back();
+	chunk = static_cast<int>(chunks.size()) - 1;
+	row = target.count++;
+
+	entities(target)[row] = entity;
+	for (const auto& component : components) {
+		std::memset(static_cast<uint8_t*>(column(target, component.id)) + row * component.size, 0, component.size);
+	}
+}
+
+Entity Archetype::remove(int chunk, int row) {
+	Chunk& last = chunks.back();
+	int lastRow = last.count - 1;
+	Chunk& target = chunks[chunk];
+
+	Entity moved = NULL_ENTITY;
+	if (&target != &last || row != lastRow) {
+		moved = entities(last)[lastRow];
+		entities(target)[row] = moved;
+		for (const auto& component : components) {
+			std::memcpy(static_cast<uint8_t*>(column(target, component.id)) + row * component.size, static_cast<uint8_t*>(column(last, component.id)) + lastRow * component.size, component.size);
+		}
+	}
+
+	// Only the first chunk stays in the list once empty. A chunk popped off
+	// the end is kept as the spare, entities come and go in bursts.
+	if (--last.count == 0 && chunks.size() > 1) {
+		spare = std::move(last.data);
+		chunks.pop_back();
+	}
+
+	return moved;
+}
+
+}
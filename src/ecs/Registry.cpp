@@ -0,0 +1,64 @@
+#include "../../include/ecs/Registry.hpp"
+#include <algorithm>
+#include <atomic>
+
+namespace ecs {
+
+int nextComponentId() {
+	static std::atomic<int> next{ 0 };
+	return next++;
+}
+
+Entity Registry::allocate() {
+	if (!freeIndices.empty()) {
+		uint32_t index = freeIndices.back();
+		freeIndices.pop_back();
+		return Entity{ index, records[index].generation };
+	}
+
+	records.push_back(Record{ nullptr, 0, 0, 0 });
+	return Entity{ static_cast<uint32_t>(records.size() - 1), 0 };
+}
+
+void Registry::destroy(Entity entity) {
+	if (!isAlive(entity)) {
+		return;
+	}
+
+	Record& record = records[entity.index];
+	Entity moved = record.archetype->remove(record.chunk, record.row);
+	if (moved != NULL_ENTITY) {
+		records[moved.index].chunk = record.chunk;
+		records[moved.index].row = record.row;
+	}
+
+	record.archetype = nullptr;
+	++record.generation;
+	freeIndices.push_back(entity.index);
+}
+
+void Registry::clear() {
+	for (uint32_t index = 0; index < records.size(); ++index) {
+		if (records[index].archetype) {
+			destroy(Entity{ index, records[index].generation });
+		}
+	}
+}
+
+Archetype* Registry::findArchetype(Signature signature) const {
+	auto found = archetypesBySignature.find(signature);
+	return found == archetypesBySignature.end() ? nullptr : found->second;
+}
+
+Archetype& Registry::addArchetype(Signature signature, std::vector<ComponentInfo> components) {
+	// Same layout whatever order the components were listed in
+	std::sort(components.begin(), components.end(), [](const ComponentInfo& a, const ComponentInfo& b) {
+		return a.id < b.id;
+	});
+
+	archetypes.emplace_back(new Archetype(signature, std::move(components)));
+	archetypesBySignature.emplace(signature, archetypes.back().get());
+	return *archetypes.back();
+}
+
+}
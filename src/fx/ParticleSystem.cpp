@@ -0,0 +1,256 @@
+#include "../../include/fx/ParticleSystem.hpp"
+#include "../../include/render/SpriteBatch.hpp"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
+namespace fx {
+
+namespace {
+
+struct EffectStyle {
+	float lifeMin, lifeMax;
+	float sizeMin, sizeMax;
+	float speedMin, speedMax;
+	// Launch direction and the arc around it, radians with y down
+	float angle, spread;
+	float gravity;
+	// Fraction of the velocity lost per second
+	float drag;
+	uint32_t colorA, colorB;
+	bool collides;
+};
+
+const float PI = 3.14159265f;
+
+const EffectStyle STYLES[static_cast<int>(EFFECT::COUNT)] = {
+	// LEAF
+	{ 6.0f, 10.0f, 5.0f, 9.0f, 8.0f, 25.0f, PI / 2.0f, 1.2f, 30.0f, 0.8f, render::packColor(60, 120, 30), render::packColor(150, 170, 40), true },
+	// DUST
+	{ 0.3f, 0.7f, 2.0f, 5.0f, 15.0f, 45.0f, -PI / 2.0f, 2.4f, 60.0f, 2.0f, render::packColor(120, 90, 50), render::packColor(170, 140, 90), false },
+	// SPARK
+	{ 0.6f, 1.2f, 2.0f, 5.0f, 40.0f, 140.0f, 0.0f, 2.0f * PI, 40.0f, 1.5f, render::packColor(255, 220, 60), render::packColor(255, 120, 20), false }
+};
+
+// Columns are widened past this many rather than indexing huge levels finely
+const int MAX_COLUMNS = 1024;
+// Seconds a particle takes to fade in, and out at the end of its life
+const float FADE_TIME = 0.5f;
+
+uint32_t mixColor(uint32_t a, uint32_t b, float t) {
+	uint32_t mixed = 0;
+	for (int shift = 0; shift < 32; shift += 8) {
+		float channelA = static_cast<float>((a >> shift) & 0xFF);
+		float channelB = static_cast<float>((b >> shift) & 0xFF);
+		mixed |= static_cast<uint32_t>(channelA + (channelB - channelA) * t) << shift;
+	}
+	return mixed;
+}
+
+}
+
+ParticleSystem::ParticleSystem(int capacity) {
+	// Padded so the last group of four never reads past the end
+	this->capacity = (capacity + 3) & ~3;
+	count = 0;
+
+	x.assign(this->capacity, 0.0f);
+	y.assign(this->capacity, 0.0f);
+	vx.assign(this->capacity, 0.0f);
+	vy.assign(this->capacity, 0.0f);
+	gravity.assign(this->capacity, 0.0f);
+	drag.assign(this->capacity, 0.0f);
+	age.assign(this->capacity, 0.0f);
+	life.assign(this->capacity, 0.0f);
+	size.assign(this->capacity, 0.0f);
+	color.assign(this->capacity, 0);
+	collides.assign(this->capacity, 0);
+
+	cellOrigin = 0.0f;
+	cellWidth = 128.0f;
+	cellStart.assign(1, 0);
+}
+
+int ParticleSystem::emit(EFFECT effect, float x0, float y0, int requested, Pcg32& random) {
+	const EffectStyle& style = STYLES[static_cast<int>(effect)];
+	int spawned = std::min(requested, capacity - count);
+
+	for (int n = 0; n < spawned; ++n) {
+		int i = count++;
+		float angle = style.angle + random.range(-style.spread / 2.0f, style.spread / 2.0f);
+		float speed = random.range(style.speedMin, style.speedMax);
+
+		x[i] = x0;
+		y[i] = y0;
+		vx[i] = speed * std::cos(angle);
+		vy[i] = speed * std::sin(angle);
+		gravity[i] = style.gravity;
+		drag[i] = style.drag;
+		age[i] = 0.0f;
+		life[i] = random.range(style.lifeMin, style.lifeMax);
+		size[i] = random.range(style.sizeMin, style.sizeMax);
+		color[i] = mixColor(style.colorA, style.colorB, random.nextFloat());
+		collides[i] = style.collides ? 1 : 0;
+	}
+	return spawned;
+}
+
+void ParticleSystem::setStaticGeometry(const std::vector<StaticBox>& source) {
+	boxes = source;
+	if (boxes.empty()) {
+		cellStart.assign(1, 0);
+		cellBoxes.clear();
+		return;
+	}
+
+	float minX = boxes[0].x0;
+	float maxX = boxes[0].x1;
+	for (const auto& box : boxes) {
+		minX = std::min(minX, box.x0);
+		maxX = std::max(maxX, box.x1);
+	}
+	cellOrigin = minX;
+	cellWidth = std::max(128.0f, (maxX - minX) / MAX_COLUMNS);
+	int columns = static_cast<int>((maxX - minX) / cellWidth) + 1;
+
+	// Counting sort of the boxes into every column they overlap
+	cellStart.assign(columns + 1, 0);
+	for (const auto& box : boxes) {
+		int first = static_cast<int>((box.x0 - cellOrigin) / cellWidth);
+		int last = std::min(static_cast<int>((box.x1 - cellOrigin) / cellWidth), columns - 1);
+		for (int column = first; column <= last; ++column) {
+			++cellStart[column];
+		}
+	}
+	int total = 0;
+	for (int column = 0; column < columns; ++column) {
+		int boxesInColumn = cellStart[column];
+		cellStart[column] = total;
+		total += boxesInColumn;
+	}
+	cellStart[columns] = total;
+
+	// Placing a box advances its column's start to the next column's, so
+	// the starts are shifted back afterwards
+	cellBoxes.resize(total);
+	for (int i = 0; i < static_cast<int>(boxes.size()); ++i) {
+		int first = static_cast<int>((boxes[i].x0 - cellOrigin) / cellWidth);
+		int last = std::min(static_cast<int>((boxes[i].x1 - cellOrigin) / cellWidth), columns - 1);
+		for (int column = first; column <= last; ++column) {
+			cellBoxes[cellStart[column]++] = i;
+		}
+	}
+	for (int column = columns; column > 0; --column) {
+		cellStart[column] = cellStart[column - 1];
+	}
+	cellStart[0] = 0;
+}
+
+void ParticleSystem::update(float dt) {
+	integrate(dt);
+	land(dt);
+	expire();
+}
+
+void ParticleSystem::integrate(float dt) {
+	int i = 0;
+#if defined(__SSE__)
+	// Rounded up to whole groups of four; the lanes past count are dead
+	// particles, updating them is harmless
+	int padded = (count + 3) & ~3;
+	const __m128 step = _mm_set1_ps(dt);
+	const __m128 one = _mm_set1_ps(1.0f);
+	for (; i < padded; i += 4) {
+		__m128 damping = _mm_sub_ps(one, _mm_mul_ps(_mm_loadu_ps(&drag[i]), step));
+		__m128 velocityX = _mm_mul_ps(_mm_loadu_ps(&vx[i]), damping);
+		__m128 velocityY = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&vy[i]), damping), _mm_mul_ps(_mm_loadu_ps(&gravity[i]), step));
+		_mm_storeu_ps(&vx[i], velocityX);
+		_mm_storeu_ps(&vy[i], velocityY);
+		_mm_storeu_ps(&x[i], _mm_add_ps(_mm_loadu_ps(&x[i]), _mm_mul_ps(velocityX, step)));
+		_mm_storeu_ps(&y[i], _mm_add_ps(_mm_loadu_ps(&y[i]), _mm_mul_ps(velocityY, step)));
+		_mm_storeu_ps(&age[i], _mm_add_ps(_mm_loadu_ps(&age[i]), step));
+	}
+#endif
+	for (; i < count; ++i) {
+		float damping = 1.0f - drag[i] * dt;
+		vx[i] *= damping;
+		vy[i] = vy[i] * damping + gravity[i] * dt;
+		x[i] += vx[i] * dt;
+		y[i] += vy[i] * dt;
+		age[i] += dt;
+	}
+}
+
+void ParticleSystem::land(float dt) {
+	int columns = static_cast<int>(cellStart.size()) - 1;
+	for (int i = 0; i < count; ++i) {
+		if (!collides[i] || vy[i] <= 0.0f) {
+			continue;
+		}
+
+		int column = static_cast<int>(std::floor((x[i] - cellOrigin) / cellWidth));
+		if (column < 0 || column >= columns) {
+			continue;
+		}
+
+		// Only a particle crossing a top face this step lands, and stays
+		float previousY = y[i] - vy[i] * dt;
+		for (int n = cellStart[column]; n < cellStart[column + 1]; ++n) {
+			const StaticBox& box = boxes[cellBoxes[n]];
+			if (x[i] >= box.x0 && x[i] < box.x1 && previousY <= box.y0 && y[i] >= box.y0) {
+				y[i] = box.y0 - size[i] / 2.0f;
+				vx[i] = 0.0f;
+				vy[i] = 0.0f;
+				gravity[i] = 0.0f;
+				break;
+			}
+		}
+	}
+}
+
+void ParticleSystem::expire() {
+	for (int i = 0; i < count;) {
+		if (age[i] >= life[i]) {
+			remove(i);
+		} else {
+			++i;
+		}
+	}
+}
+
+void ParticleSystem::remove(int i) {
+	int last = --count;
+	x[i] = x[last];
+	y[i] = y[last];
+	vx[i] = vx[last];
+	vy[i] = vy[last];
+	gravity[i] = gravity[last];
+	drag[i] = drag[last];
+	age[i] = age[last];
+	life[i] = life[last];
+	size[i] = size[last];
+	color[i] = color[last];
+	collides[i] = collides[last];
+}
+
+void ParticleSystem::publish(std::vector<render::ParticleInstance>& out, int spriteId, float x0, float x1) const {
+	if (spriteId < 0) {
+		return;
+	}
+
+	for (int i = 0; i < count; ++i) {
+		float half = size[i] / 2.0f;
+		if (x[i] + half <= x0 || x[i] - half >= x1) {
+			continue;
+		}
+
+		float fade = std::min(std::min(age[i], life[i] - age[i]) / FADE_TIME, 1.0f);
+		uint32_t alpha = static_cast<uint32_t>(((color[i] >> 24) & 0xFF) * fade);
+		out.push_back(render::ParticleInstance{ spriteId, x[i], y[i], size[i], (color[i] & 0x00FFFFFFu) | (alpha << 24) });
+	}
+}
+
+}
@@ -1,10 +1,11 @@
 #include "../../include/physics/Arbiter.hpp"
+#include "../../include/physics/World.hpp"
 #include <iostream>
 
 namespace physics {
 
 ArbiterKey::ArbiterKey(Body* b1, Body* b2) {
-	if (b1 < b2) {
+	if (b1->serial < b2->serial) {
 		body1 = b1; body2 = b2;
 	} else {
 		body1 = b2; body2 = b1;
@@ -12,7 +13,7 @@ ArbiterKey::ArbiterKey(Body* b1, Body* b2) {
 }
 
 Arbiter::Arbiter(Body* b1, Body* b2) {
-	if (b1 < b2) {
+	if (b1->serial < b2->serial) {
 		body1 = b1;
 		body2 = b2;
 	} else {
@@ -23,6 +24,7 @@ Arbiter::Arbiter(Body* b1, Body* b2) {
 	numContacts = collide(contacts, body1, body2);
 
 	friction = sqrtf(body1->friction * body2->friction);
+	blockSolve = false;
 }
 
 void Arbiter::update(Contact* newContacts, int numNewContacts) {
@@ -46,11 +48,9 @@ void Arbiter::update(Contact* newContacts, int numNewContacts) {
 			if (World::warmStarting) {
 				c->pNormal = cOld->pNormal;
 				c->pTangent = cOld->pTangent;
-				c->pNormalBias = cOld->pNormalBias;
 			} else {
 				c->pNormal = 0.0f;
 				c->pTangent = 0.0f;
-				c->pNormalBias = 0.0f;
 			}
 		} else {
 			mergedContacts[i] = newContacts[i];
@@ -66,13 +66,17 @@ void Arbiter::update(Contact* newContacts, int numNewContacts) {
 
 void Arbiter::preStep(float invDt) {
 	const float kAllowedPenetration = 0.01f;
+	// Beyond this condition number the block solve isn't trusted
+	const float kMaxCondition = 1000.0f;
 	float kBiasFactor = World::positionCorrection ? 0.2f : 0.0f;
 
 	for (int i = 0; i < numContacts; ++i) {
 		Contact* c = contacts + i;
 
-		Vec2 r1 = c->position - body1->position;
-		Vec2 r2 = c->position - body2->position;
+		c->r1 = c->position - body1->position;
+		c->r2 = c->position - body2->position;
+		Vec2 r1 = c->r1;
+		Vec2 r2 = c->r2;
 
 		float rn1 = dot(r1, c->normal);
 		float rn2 = dot(r2, c->normal);
@@ -88,82 +92,231 @@ void Arbiter::preStep(float invDt) {
 		c->massTangent = 1.0f /  kTangent;
 
 		c->bias = -kBiasFactor * invDt * min(0.0f, c->separation + kAllowedPenetration);
+		// Pushing out is redone from scratch every step
+		c->pNormalBias = 0.0f;
 
 		if (World::accumulateImpulses) {
-			Vec2 P = c->pNormal * c->normal + c->pTangent * tangent;
+			applyImpulse(c, c->pNormal * c->normal + c->pTangent * tangent);
+		}
+	}
 
-			body1->velocity -= body1->invMass * P;
-			body2->velocity += body2->invMass * P;
+	blockSolve = false;
+	if (numContacts == 2 && World::blockSolver && World::accumulateImpulses) {
+		Contact* c1 = contacts;
+		Contact* c2 = contacts + 1;
+		float rn11 = cross(c1->r1, c1->normal);
+		float rn12 = cross(c1->r2, c1->normal);
+		float rn21 = cross(c2->r1, c2->normal);
+		float rn22 = cross(c2->r2, c2->normal);
+
+		float k11 = 1.0f / c1->massNormal;
+		float k22 = 1.0f / c2->massNormal;
+		float k12 = (body1->invMass + body2->invMass) * dot(c1->normal, c2->normal) + body1->invI * rn11 * rn21 + body2->invI * rn12 * rn22;
+
+		// Without rotation both points move as one and K is singular. Close
+		// to that, round off would make the solve blow up.
+		if (k11 * k11 < kMaxCondition * (k11 * k22 - k12 * k12)) {
+			K = Mat22(Vec2(k11, k12), Vec2(k12, k22));
+			normalMass = K.invert();
+			blockSolve = true;
 		}
 	}
 }
 
 void Arbiter::applyImpulse() {
+	if (blockSolve) {
+		applyBlockNormalImpulse();
+		for (int i = 0; i < numContacts; ++i) {
+			applyTangentImpulse(contacts + i, 0.0f);
+		}
+		return;
+	}
+
+	for (int i = 0; i < numContacts; ++i) {
+		float dPn = applyNormalImpulse(contacts + i);
+		applyTangentImpulse(contacts + i, dPn);
+	}
+}
+
+void Arbiter::applyImpulse(Contact* c, const Vec2& P) {
+	body1->velocity -= body1->invMass * P;
+	body1->angularVelocity -= body1->invI * cross(c->r1, P);
+
+	body2->velocity += body2->invMass * P;
+	body2->angularVelocity += body2->invI * cross(c->r2, P);
+}
+
+float Arbiter::velocityBias(const Contact* c) const {
+	// With split impulses the bias goes to the pseudo velocities instead
+	return World::splitImpulse ? 0.0f : c->bias;
+}
+
+float Arbiter::applyNormalImpulse(Contact* c) {
 	Body* b1 = body1;
 	Body* b2 = body2;
 
-	for (int i = 0; i < numContacts; ++i) {
-		Contact* c = contacts + i;
-		c->r1 = c->position - b1->position;
-		c->r2 = c->position - b2->position;
+	// Relative velocity at contact
+	Vec2 dv = b2->velocity + cross(b2->angularVelocity, c->r2) - b1->velocity - cross(b1->angularVelocity, c->r1);
 
-		// Relative velocity at contact
-		Vec2 dv = b2->velocity + cross(b2->angularVelocity, c->r2) - b1->velocity - cross(b1->angularVelocity, c->r1);
+	// Compute normal impulse
+	float vn = dot(dv, c->normal);
 
-		// Compute normal impulse
-		float vn = dot(dv, c->normal);
+	float dPn = c->massNormal * (-vn + velocityBias(c));
 
-		float dPn = c->massNormal * (-vn + c->bias);
+	if (World::accumulateImpulses) {
+		// Clamp the accumulated impulse
+		float Pn0 = c->pNormal;
+		c->pNormal = max(Pn0 + dPn, 0.0f);
+		dPn = c->pNormal - Pn0;
+	} else {
+		dPn = max(dPn, 0.0f);
+	}
 
-		if (World::accumulateImpulses) {
-			// Clamp the accumulated impulse
-			float Pn0 = c->pNormal;
-			c->pNormal = max(Pn0 + dPn, 0.0f);
-			dPn = c->pNormal - Pn0;
-		} else {
-			dPn = max(dPn, 0.0f);
-		}
+	// Apply contact impulse
+	applyImpulse(c, dPn * c->normal);
+	return dPn;
+}
 
-		// Apply contact impulse
-		Vec2 pNormal = dPn * c->normal;
+// Solves vn = K x + b, vn >= 0, x >= 0, vn_i x_i = 0 for the accumulated
+// normal impulses x by trying the four cases in turn: both points pushing,
+// only the first, only the second, neither. In terms of the impulses a
+// applied so far, b = vn0 - K a with vn0 the current normal velocity less
+// the target, so that each case's x is the total impulse. False when there
+// is no solution, which round off alone can cause.
+bool Arbiter::solveBlock(const Vec2& vn0, const Vec2& a, Vec2& x) const {
+	Vec2 b = vn0 - K * a;
+
+	// Both points pushing
+	x = -(normalMass * b);
+	if (x.x >= 0.0f && x.y >= 0.0f) {
+		return true;
+	}
 
-		b1->velocity -= b1->invMass * pNormal;
-		b2->velocity += b2->invMass * pNormal;
+	// Only the first
+	x.set(-contacts[0].massNormal * b.x, 0.0f);
+	float vn2 = K.col1.y * x.x + b.y;
+	if (x.x >= 0.0f && vn2 >= 0.0f) {
+		return true;
+	}
 
-		// Relative velocity at contact
-		dv = b2->velocity + cross(b2->angularVelocity, c->r2) - b1->velocity - cross(b1->angularVelocity, c->r1);
+	// Only the second
+	x.set(0.0f, -contacts[1].massNormal * b.y);
+	float vn1 = K.col2.x * x.y + b.x;
+	if (x.y >= 0.0f && vn1 >= 0.0f) {
+		return true;
+	}
 
-		Vec2 tangent = cross(c->normal, 1.0f);
-		float vt = dot(dv, tangent);
-		float dPt = c->massTangent * (-vt);
+	// Neither, the points are separating
+	x.set(0.0f, 0.0f);
+	return b.x >= 0.0f && b.y >= 0.0f;
+}
 
-		if (World::accumulateImpulses) {
-			// Compute friction impulse
-			float maxPt = friction * c->pNormal;
+void Arbiter::applyBlockNormalImpulse() {
+	Body* b1 = body1;
+	Body* b2 = body2;
+	Contact* c1 = contacts;
+	Contact* c2 = contacts + 1;
 
-			// Clamp friction
-			float oldTangentImpulse = c->pTangent;
-			c->pTangent = clamp(oldTangentImpulse + dPt, -maxPt, maxPt);
-			dPt = c->pTangent - oldTangentImpulse;
-		} else {
-			float maxPt = friction * dPn;
-			dPt = clamp(dPt, -maxPt, maxPt);
+	Vec2 dv1 = b2->velocity + cross(b2->angularVelocity, c1->r2) - b1->velocity - cross(b1->angularVelocity, c1->r1);
+	Vec2 dv2 = b2->velocity + cross(b2->angularVelocity, c2->r2) - b1->velocity - cross(b1->angularVelocity, c2->r1);
+
+	Vec2 a(c1->pNormal, c2->pNormal);
+	Vec2 vn(dot(dv1, c1->normal) - velocityBias(c1), dot(dv2, c2->normal) - velocityBias(c2));
+	Vec2 x;
+	if (!solveBlock(vn, a, x)) {
+		return;
+	}
+
+	Vec2 d = x - a;
+	applyImpulse(c1, d.x * c1->normal);
+	applyImpulse(c2, d.y * c2->normal);
+	c1->pNormal = x.x;
+	c2->pNormal = x.y;
+}
+
+void Arbiter::applyTangentImpulse(Contact* c, float dPn) {
+	Body* b1 = body1;
+	Body* b2 = body2;
+
+	// Relative velocity at contact
+	Vec2 dv = b2->velocity + cross(b2->angularVelocity, c->r2) - b1->velocity - cross(b1->angularVelocity, c->r1);
+
+	Vec2 tangent = cross(c->normal, 1.0f);
+	float vt = dot(dv, tangent);
+	float dPt = c->massTangent * (-vt);
+
+	if (World::accumulateImpulses) {
+		// Compute friction impulse
+		float maxPt = friction * c->pNormal;
+
+		// Clamp friction
+		float oldTangentImpulse = c->pTangent;
+		c->pTangent = clamp(oldTangentImpulse + dPt, -maxPt, maxPt);
+		dPt = c->pTangent - oldTangentImpulse;
+	} else {
+		float maxPt = friction * dPn;
+		dPt = clamp(dPt, -maxPt, maxPt);
+	}
+
+	// Apply contact impulse
+	applyImpulse(c, dPt * tangent);
+}
+
+// Split impulse: the same contact constraint on the pseudo velocities, driven
+// by the bias alone. Bodies get pushed apart without gaining momentum, so a
+// resting contact doesn't bounce back out after correcting penetration.
+void Arbiter::applyBiasImpulse() {
+	Body* b1 = body1;
+	Body* b2 = body2;
+
+	if (blockSolve) {
+		// Pushing one point at a time out would tip the body over
+		Contact* c1 = contacts;
+		Contact* c2 = contacts + 1;
+		Vec2 dv1 = b2->biasVelocity + cross(b2->biasAngularVelocity, c1->r2) - b1->biasVelocity - cross(b1->biasAngularVelocity, c1->r1);
+		Vec2 dv2 = b2->biasVelocity + cross(b2->biasAngularVelocity, c2->r2) - b1->biasVelocity - cross(b1->biasAngularVelocity, c2->r1);
+
+		Vec2 a(c1->pNormalBias, c2->pNormalBias);
+		Vec2 vn(dot(dv1, c1->normal) - c1->bias, dot(dv2, c2->normal) - c2->bias);
+		Vec2 x;
+		if (solveBlock(vn, a, x)) {
+			Vec2 d = x - a;
+			applyBiasImpulse(c1, d.x * c1->normal);
+			applyBiasImpulse(c2, d.y * c2->normal);
+			c1->pNormalBias = x.x;
+			c2->pNormalBias = x.y;
 		}
+		return;
+	}
 
-		// Apply contact impulse
-		Vec2 pTangent = dPt * tangent;
+	for (int i = 0; i < numContacts; ++i) {
+		Contact* c = contacts + i;
+		Vec2 dv = b2->biasVelocity + cross(b2->biasAngularVelocity, c->r2) - b1->biasVelocity - cross(b1->biasAngularVelocity, c->r1);
+		float vn = dot(dv, c->normal);
+
+		float dPnb = c->massNormal * (-vn + c->bias);
+		float Pnb0 = c->pNormalBias;
+		c->pNormalBias = max(Pnb0 + dPnb, 0.0f);
+		dPnb = c->pNormalBias - Pnb0;
 
-		b1->velocity -= b1->invMass * pTangent;
-		b2->velocity += b2->invMass * pTangent;
+		applyBiasImpulse(c, dPnb * c->normal);
 	}
 }
 
+void Arbiter::applyBiasImpulse(Contact* c, const Vec2& P) {
+	body1->biasVelocity -= body1->invMass * P;
+	body1->biasAngularVelocity -= body1->invI * cross(c->r1, P);
+
+	body2->biasVelocity += body2->invMass * P;
+	body2->biasAngularVelocity += body2->invI * cross(c->r2, P);
+}
+
 bool operator<(const ArbiterKey& a1, const ArbiterKey& a2) {
-	if (a1.body1 < a2.body1) {
+	if (a1.body1->serial < a2.body1->serial) {
 		return true;
 	}
 
-	if (a1.body1 == a2.body1 && a1.body2 < a2.body2) {
+	if (a1.body1 == a2.body1 && a1.body2->serial < a2.body2->serial) {
 		return true;
 	}
 	return false;
@@ -0,0 +1,46 @@
+#include "../../include/physics/ArbiterMap.hpp"
+#include <algorithm>
+
+namespace physics {
+
+static bool keyLess(const ArbiterMap::value_type& entry, const ArbiterKey& key) {
+	return entry.first < key;
+}
+
+ArbiterMap::iterator ArbiterMap::lowerBound(const ArbiterKey& key) {
+	return std::lower_bound(entries.begin(), entries.end(), key, keyLess);
+}
+
+ArbiterMap::const_iterator ArbiterMap::lowerBound(const ArbiterKey& key) const {
+	return std::lower_bound(entries.begin(), entries.end(), key, keyLess);
+}
+
+ArbiterMap::iterator ArbiterMap::find(const ArbiterKey& key) {
+	iterator iter = lowerBound(key);
+	if (iter == entries.end() || key < iter->first) {
+		return entries.end();
+	}
+	return iter;
+}
+
+size_t ArbiterMap::count(const ArbiterKey& key) const {
+	const_iterator iter = lowerBound(key);
+	return iter != entries.end() && !(key < iter->first) ? 1 : 0;
+}
+
+void ArbiterMap::insert(const value_type& entry) {
+	entries.insert(lowerBound(entry.first), entry);
+}
+
+ArbiterMap::iterator ArbiterMap::erase(iterator position) {
+	return entries.erase(position);
+}
+
+void ArbiterMap::erase(const ArbiterKey& key) {
+	iterator iter = find(key);
+	if (iter != entries.end()) {
+		entries.erase(iter);
+	}
+}
+
+}
@@ -12,30 +12,38 @@ Body::Body() {
 
 	rotation = 0.0f;
 	angularVelocity = 0.0f;
+	biasVelocity.set(0.0f, 0.0f);
+	biasAngularVelocity = 0.0f;
 	torque = 0.0f;
 	friction = 0.2f;
 	mass = FLT_MAX;
 	invMass = 0.f;
 	I = FLT_MAX;
 	invI = 0.0f;
+	shape = SHAPE::BOX;
+	group = 0;
+	fixedRotation = false;
 	canJump = false;
 	id = 0;
-	textureId = 0;
+	serial = 0;
 }
 
 void Body::addForce(const Vec2 &f) {
 	force += f;
 }
 
-void Body::set(const Vec2& w, float m) {
+void Body::set(const Vec2& w, float m, SHAPE s) {
 	position.set(0.0f, 0.0f);
 	velocity.set(0.0f, 0.0f);
 	force.set(0.0f, 0.0f);
 	terminalVelocity.set(0.0f, 0.0f);
 	width = w;
+	shape = s;
 
 	rotation = 0.0f;
 	angularVelocity = 0.0f;
+	biasVelocity.set(0.0f, 0.0f);
+	biasAngularVelocity = 0.0f;
 	torque = 0.0f;
 	friction = 0.2f;
 	setMass(m);
@@ -47,7 +55,17 @@ void Body::setMass(float m) {
 
 	if (mass < FLT_MAX)	{
 		invMass = 1.0f / mass;
-		I = mass * (width.x * width.x + width.y * width.y) / 12.0f;
+		if (fixedRotation) {
+			I = FLT_MAX;
+			invI = 0.0f;
+			return;
+		}
+		if (shape == SHAPE::CIRCLE) {
+			I = mass * width.x * width.x / 8.0f;
+		} else {
+			// Capsules are close enough to their bounding box
+			I = mass * (width.x * width.x + width.y * width.y) / 12.0f;
+		}
 		invI = 1.0f / I;
 	} else {
 		invMass = 0.0f;
@@ -56,29 +74,4 @@ void Body::setMass(float m) {
 	}
 }
 
-void Body::applyTexture(GLuint textureId) {
-    this->textureId = textureId;
-}
-
-void Body::draw() const {
-    glBindTexture(GL_TEXTURE_2D, textureId);
-
-    glBegin(GL_POLYGON);
-    glTexCoord2f(0.0f, 0.0f);
-    glVertex2f(position.x - width.x / 2.0f, position.y - width.y / 2.0f);
-
-    glTexCoord2f(1.0f, 0.0f);
-    glVertex2f(position.x + width.x / 2.0f, position.y - width.y / 2.0f);
-
-    glTexCoord2f(1.0f, 1.0f);
-    glVertex2f(position.x + width.x / 2.0f, position.y + width.y / 2.0f);
-
-    glTexCoord2f(0.0f, 1.0f);
-    glVertex2f(position.x - width.x / 2.0f, position.y + width.y / 2.0f);
-    glEnd();
-
-    // Unbind the texture
-    glBindTexture(GL_TEXTURE_2D, 0);
-}
-
 }
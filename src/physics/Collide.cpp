@@ -2,8 +2,6 @@
 
 namespace physics {
 
-typedef std::pair<int, std::vector<Vec2>> ContactResult;
-
 void flip(FeaturePair& fp) {
 	swap(fp.e.inEdge1, fp.e.inEdge2);
 	swap(fp.e.outEdge1, fp.e.outEdge2);
@@ -95,9 +93,7 @@ void computeIncidentEdge(ClipVertex c[2], const Vec2& h, const Vec2& pos, const
 }
 
 // The normal points from A to B
-int collide(Contact* contacts, Body* bodyA, Body* bodyB) {
-	std::vector<Vec2> contactPoints;
-	contactPoints.reserve(2);
+int collideBoxes(Contact* contacts, Body* bodyA, Body* bodyB) {
 	// setup
 	Vec2 hA = 0.5f * bodyA->width;
 	Vec2 hB = 0.5f * bodyB->width;
@@ -263,4 +259,30 @@ int collide(Contact* contacts, Body* bodyA, Body* bodyB) {
 	return numContacts;
 }
 
+typedef int (*Collider)(Contact* contacts, Body* bodyA, Body* bodyB);
+
+// Upper triangle only, the rest is the mirrored pair
+static const Collider COLLIDERS[static_cast<int>(SHAPE::COUNT)][static_cast<int>(SHAPE::COUNT)] = {
+	//             BOX            CIRCLE            CAPSULE
+	/* BOX */     { collideBoxes, collideBoxCircle, collideBoxCapsule },
+	/* CIRCLE */  { nullptr,      collideCircles,   collideCircleCapsule },
+	/* CAPSULE */ { nullptr,      nullptr,          collideCapsules }
+};
+
+int collide(Contact* contacts, Body* bodyA, Body* bodyB) {
+	int shapeA = static_cast<int>(bodyA->shape);
+	int shapeB = static_cast<int>(bodyB->shape);
+	if (shapeA <= shapeB) {
+		return COLLIDERS[shapeA][shapeB](contacts, bodyA, bodyB);
+	}
+
+	// Run the mirrored test and turn its normals around
+	int numContacts = COLLIDERS[shapeB][shapeA](contacts, bodyB, bodyA);
+	for (int i = 0; i < numContacts; ++i) {
+		contacts[i].normal = -contacts[i].normal;
+		flip(contacts[i].feature);
+	}
+	return numContacts;
+}
+
 }
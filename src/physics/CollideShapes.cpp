@@ -0,0 +1,237 @@
+#include "../../include/physics/Collide.hpp"
+#include <cmath>
+
+namespace physics {
+
+namespace {
+
+// Closest point of a box to a point, both in the box frame. Points inside
+// are pushed out through the nearest face. The region (1-9, the 3x3 grid of
+// faces, corners and inside around the box) names the part of the box that
+// was hit, and is what the box side of a feature pair is made of.
+struct BoxPoint {
+	Vec2 point;
+	Vec2 face;
+	char region;
+	bool inside;
+};
+
+BoxPoint closestOnBox(const Vec2& p, const Vec2& h) {
+	BoxPoint result;
+	int sideX = p.x > h.x ? 1 : (p.x < -h.x ? -1 : 0);
+	int sideY = p.y > h.y ? 1 : (p.y < -h.y ? -1 : 0);
+	result.inside = sideX == 0 && sideY == 0;
+
+	if (result.inside) {
+		if (h.x - std::fabs(p.x) < h.y - std::fabs(p.y)) {
+			sideX = p.x < 0.0f ? -1 : 1;
+		} else {
+			sideY = p.y < 0.0f ? -1 : 1;
+		}
+		result.point.set(sideX != 0 ? sideX * h.x : p.x, sideY != 0 ? sideY * h.y : p.y);
+	} else {
+		result.point.set(clamp(p.x, -h.x, h.x), clamp(p.y, -h.y, h.y));
+	}
+	result.face.set(static_cast<float>(sideX), static_cast<float>(sideY));
+	result.region = static_cast<char>(1 + (sideX + 1) + 3 * (sideY + 1));
+	return result;
+}
+
+// Signed distance from a point in the box frame to the box
+float boxDistance(const Vec2& p, const Vec2& h) {
+	BoxPoint q = closestOnBox(p, h);
+	float distance = (p - q.point).length();
+	return q.inside ? -distance : distance;
+}
+
+// Contact between a box and a disc of the given radius, its center in the
+// box frame. The normal points from the box to the disc.
+bool boxDiscContact(Contact& contact, const Body* box, const Mat22& rot, const Vec2& center, float radius, char discFeature) {
+	Vec2 h = 0.5f * box->width;
+	BoxPoint q = closestOnBox(center, h);
+	Vec2 d = center - q.point;
+	float distance = d.length();
+
+	Vec2 normal;
+	if (q.inside) {
+		normal = q.face;
+		distance = -distance;
+	} else if (distance > radius) {
+		return false;
+	} else if (distance > FLT_EPSILON) {
+		normal = (1.0f / distance) * d;
+	} else {
+		normal = (1.0f / q.face.length()) * q.face;
+	}
+
+	contact.normal = rot * normal;
+	contact.position = box->position + rot * q.point;
+	contact.separation = distance - radius;
+	contact.feature.value = 0;
+	contact.feature.e.inEdge1 = q.region;
+	contact.feature.e.inEdge2 = discFeature;
+	return true;
+}
+
+// Contact between two discs, the normal pointing from A to B
+int discContact(Contact* contacts, const Vec2& centerA, float radiusA, const Vec2& centerB, float radiusB, char featureB) {
+	Vec2 d = centerB - centerA;
+	float distance = d.length();
+	if (distance > radiusA + radiusB) {
+		return 0;
+	}
+
+	Vec2 normal = distance > FLT_EPSILON ? (1.0f / distance) * d : Vec2(0.0f, 1.0f);
+	contacts[0].normal = normal;
+	contacts[0].position = centerA + radiusA * normal;
+	contacts[0].separation = distance - radiusA - radiusB;
+	contacts[0].feature.value = 0;
+	contacts[0].feature.e.inEdge2 = featureB;
+	return 1;
+}
+
+float circleRadius(const Body* body) {
+	return 0.5f * body->width.x;
+}
+
+// World space segment between the centers of a capsule's caps
+void capsuleSegment(const Body* body, Vec2& a, Vec2& b, float& radius) {
+	radius = 0.5f * body->width.x;
+	float halfLength = max(0.5f * body->width.y - radius, 0.0f);
+	Vec2 axis = halfLength * Mat22(body->rotation).col2;
+	a = body->position - axis;
+	b = body->position + axis;
+}
+
+// Parameter of the point of segment [a, b] closest to p
+float closestOnSegment(const Vec2& p, const Vec2& a, const Vec2& b) {
+	Vec2 ab = b - a;
+	float lengthSq = dot(ab, ab);
+	if (lengthSq <= FLT_EPSILON) {
+		return 0.0f;
+	}
+	return clamp(dot(p - a, ab) / lengthSq, 0.0f, 1.0f);
+}
+
+// Caps and the side of a capsule, which end of the segment a contact is on
+char capsuleFeature(float t) {
+	return t <= 0.0f ? EDGE1 : (t >= 1.0f ? EDGE2 : EDGE3);
+}
+
+}
+
+int collideBoxCircle(Contact* contacts, Body* box, Body* circle) {
+	Mat22 rot(box->rotation);
+	Vec2 center = rot.transpose() * (circle->position - box->position);
+	return boxDiscContact(contacts[0], box, rot, center, circleRadius(circle), NO_EDGE) ? 1 : 0;
+}
+
+int collideBoxCapsule(Contact* contacts, Body* box, Body* capsule) {
+	Mat22 rot(box->rotation);
+	Mat22 rotT = rot.transpose();
+	Vec2 h = 0.5f * box->width;
+
+	Vec2 a, b;
+	float radius;
+	capsuleSegment(capsule, a, b, radius);
+	a = rotT * (a - box->position);
+	b = rotT * (b - box->position);
+
+	// The deepest point of the segment is one of its ends or the point
+	// nearest to one of the box corners. Corners nearest to an end are left
+	// to the end, so the feature doesn't flicker between the two.
+	Vec2 candidates[6];
+	candidates[0] = a;
+	candidates[1] = b;
+	const Vec2 corners[4] = { Vec2(h.x, h.y), Vec2(-h.x, h.y), Vec2(-h.x, -h.y), Vec2(h.x, -h.y) };
+	int deepest = 0;
+	float deepestDistance = boxDistance(candidates[0], h);
+	for (int i = 1; i < 6; ++i) {
+		if (i >= 2) {
+			float t = closestOnSegment(corners[i - 2], a, b);
+			if (t <= 0.0f || t >= 1.0f) {
+				continue;
+			}
+			candidates[i] = a + t * (b - a);
+		}
+		float distance = boxDistance(candidates[i], h);
+		if (distance < deepestDistance) {
+			deepest = i;
+			deepestDistance = distance;
+		}
+	}
+
+	if (!boxDiscContact(contacts[0], box, rot, candidates[deepest], radius, static_cast<char>(deepest + 1))) {
+		return 0;
+	}
+
+	// Lying along a face, the other end touches it too
+	if (deepest < 2) {
+		int other = 1 - deepest;
+		if (boxDiscContact(contacts[1], box, rot, candidates[other], radius, static_cast<char>(other + 1))
+			&& dot(contacts[0].normal, contacts[1].normal) > 0.99f) {
+			return 2;
+		}
+	}
+	return 1;
+}
+
+int collideCircles(Contact* contacts, Body* bodyA, Body* bodyB) {
+	return discContact(contacts, bodyA->position, circleRadius(bodyA), bodyB->position, circleRadius(bodyB), NO_EDGE);
+}
+
+int collideCircleCapsule(Contact* contacts, Body* circle, Body* capsule) {
+	Vec2 a, b;
+	float radius;
+	capsuleSegment(capsule, a, b, radius);
+	float t = closestOnSegment(circle->position, a, b);
+	return discContact(contacts, circle->position, circleRadius(circle), a + t * (b - a), radius, capsuleFeature(t));
+}
+
+int collideCapsules(Contact* contacts, Body* bodyA, Body* bodyB) {
+	Vec2 a1, a2, b1, b2;
+	float radiusA, radiusB;
+	capsuleSegment(bodyA, a1, a2, radiusA);
+	capsuleSegment(bodyB, b1, b2, radiusB);
+
+	// Closest points of two segments, Ericson's Real-Time Collision Detection 5.1.9
+	Vec2 d1 = a2 - a1;
+	Vec2 d2 = b2 - b1;
+	Vec2 r = a1 - b1;
+	float a = dot(d1, d1);
+	float e = dot(d2, d2);
+	float f = dot(d2, r);
+	float s, t;
+	if (a <= FLT_EPSILON && e <= FLT_EPSILON) {
+		s = t = 0.0f;
+	} else if (a <= FLT_EPSILON) {
+		s = 0.0f;
+		t = clamp(f / e, 0.0f, 1.0f);
+	} else {
+		float c = dot(d1, r);
+		if (e <= FLT_EPSILON) {
+			t = 0.0f;
+			s = clamp(-c / a, 0.0f, 1.0f);
+		} else {
+			float b = dot(d1, d2);
+			float denom = a * e - b * b;
+			s = denom > FLT_EPSILON ? clamp((b * f - c * e) / denom, 0.0f, 1.0f) : 0.0f;
+			t = (b * s + f) / e;
+			if (t < 0.0f) {
+				t = 0.0f;
+				s = clamp(-c / a, 0.0f, 1.0f);
+			} else if (t > 1.0f) {
+				t = 1.0f;
+				s = clamp((b - c) / a, 0.0f, 1.0f);
+			}
+		}
+	}
+
+	int numContacts = discContact(contacts, a1 + s * d1, radiusA, b1 + t * d2, radiusB, capsuleFeature(t));
+	if (numContacts > 0) {
+		contacts[0].feature.e.inEdge1 = capsuleFeature(s);
+	}
+	return numContacts;
+}
+
+}
@@ -1,4 +1,5 @@
 #include "../../include/physics/Joint.hpp"
+#include <GL/gl.h>
 
 namespace physics {
 
@@ -105,7 +106,9 @@ void Joint::applyImpulse() {
 
 	Vec2 impulse;
 
-	impulse = mat * (bias - dv - softness * p);
+	// With split impulses the bias goes to the pseudo velocities instead
+	Vec2 target = World::splitImpulse ? Vec2(0.0f, 0.0f) : bias;
+	impulse = mat * (target - dv - softness * p);
 
 	body1->velocity -= body1->invMass * impulse;
 	body1->angularVelocity -= body1->invI * cross(r1, impulse);
@@ -116,6 +119,17 @@ void Joint::applyImpulse() {
 	p += impulse;
 }
 
+void Joint::applyBiasImpulse() {
+	Vec2 dv = body2->biasVelocity + cross(body2->biasAngularVelocity, r2) - body1->biasVelocity - cross(body1->biasAngularVelocity, r1);
+	Vec2 impulse = mat * (bias - dv);
+
+	body1->biasVelocity -= body1->invMass * impulse;
+	body1->biasAngularVelocity -= body1->invI * cross(r1, impulse);
+
+	body2->biasVelocity += body2->invMass * impulse;
+	body2->biasAngularVelocity += body2->invI * cross(r2, impulse);
+}
+
 void Joint::draw() {
 	Body* b1 = body1;
 	Body* b2 = body2;
@@ -1,4 +1,5 @@
 #include "../../include/physics/Math.hpp"
+#include "../../include/utils/Random.hpp"
 
 namespace physics {
 
@@ -58,6 +59,48 @@ float sign(float x) {
 	return x < 0.0f ? -1.0f : 1.0f;
 }
 
+#ifdef JUNGLE_WAYS_DETERMINISTIC
+// The C library's sinf and cosf differ between versions and platforms, so
+// the deterministic build brings its own: Cody-Waite reduction to an octant
+// and the Cephes polynomials, plain float arithmetic throughout. Accurate to
+// a couple of ulps for angles up to a few thousand radians.
+void sinCos(float angle, float& s, float& c) {
+	const float FOUR_OVER_PI = 1.27323954f;
+	const float DP1 = 0.78515625f;
+	const float DP2 = 2.4187564849853515625e-4f;
+	const float DP3 = 3.77489497744594108e-8f;
+
+	float x = angle < 0.0f ? -angle : angle;
+	int j = static_cast<int>(x * FOUR_OVER_PI);
+	j = (j + 1) & ~1;
+	float y = static_cast<float>(j);
+	x = ((x - y * DP1) - y * DP2) - y * DP3;
+
+	float z = x * x;
+	float sinPoly = ((-1.9515295891e-4f * z + 8.3321608736e-3f) * z - 1.6666654611e-1f) * z * x + x;
+	float cosPoly = ((2.443315711809948e-5f * z - 1.388731625493765e-3f) * z + 4.166664568298827e-2f) * z * z - 0.5f * z + 1.0f;
+
+	int octant = j & 7;
+	bool swapped = octant == 2 || octant == 6;
+	s = swapped ? cosPoly : sinPoly;
+	c = swapped ? sinPoly : cosPoly;
+	if (octant >= 4) {
+		s = -s;
+	}
+	if (octant == 2 || octant == 4) {
+		c = -c;
+	}
+	if (angle < 0.0f) {
+		s = -s;
+	}
+}
+#else
+void sinCos(float angle, float& s, float& c) {
+	s = sinf(angle);
+	c = cosf(angle);
+}
+#endif
+
 float min(float a, float b) {
 	return a < b ? a : b;
 }
@@ -72,17 +115,11 @@ float clamp(float a, float low, float high) {
 
 // Random number in range [-1,1]
 float random() {
-	float r = (float) rand();
-	r /= (float) RAND_MAX;
-	r = 2.0f * r - 1.0f;
-	return r;
+	return rng::stream(RNG_STREAM::PHYSICS).range(-1.0f, 1.0f);
 }
 
 float random(float lo, float hi) {
-	float r = (float) rand();
-	r /= (float) RAND_MAX;
-	r = (hi - lo) * r + lo;
-	return r;
+	return rng::stream(RNG_STREAM::PHYSICS).range(lo, hi);
 }
 
 }
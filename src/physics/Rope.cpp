@@ -0,0 +1,202 @@
+#include "../../include/physics/Rope.hpp"
+#include "../../include/physics/World.hpp"
+
+namespace physics {
+
+// Velocity change at r per unit impulse applied there, zero for the world
+static Mat22 pointMass(const Body* body, const Vec2& r) {
+	Mat22 K;
+	K.col1.set(0.0f, 0.0f);
+	K.col2.set(0.0f, 0.0f);
+	if (body != nullptr) {
+		K.col1.x = body->invMass + body->invI * r.y * r.y;
+		K.col2.x = -body->invI * r.x * r.y;
+		K.col1.y = -body->invI * r.x * r.y;
+		K.col2.y = body->invMass + body->invI * r.x * r.x;
+	}
+	return K;
+}
+
+static Vec2 pointVelocity(const Body* body, const Vec2& r) {
+	if (body == nullptr) {
+		return Vec2(0.0f, 0.0f);
+	}
+	return body->velocity + cross(body->angularVelocity, r);
+}
+
+static Vec2 pointBiasVelocity(const Body* body, const Vec2& r) {
+	if (body == nullptr) {
+		return Vec2(0.0f, 0.0f);
+	}
+	return body->biasVelocity + cross(body->biasAngularVelocity, r);
+}
+
+static void applyLinkBiasImpulse(RopeLink& link, const Vec2& impulse) {
+	if (link.body1 != nullptr) {
+		link.body1->biasVelocity -= link.body1->invMass * impulse;
+		link.body1->biasAngularVelocity -= link.body1->invI * cross(link.r1, impulse);
+	}
+	link.body2->biasVelocity += link.body2->invMass * impulse;
+	link.body2->biasAngularVelocity += link.body2->invI * cross(link.r2, impulse);
+}
+
+static void applyLinkImpulse(RopeLink& link, const Vec2& impulse) {
+	if (link.body1 != nullptr) {
+		link.body1->velocity -= link.body1->invMass * impulse;
+		link.body1->angularVelocity -= link.body1->invI * cross(link.r1, impulse);
+	}
+	link.body2->velocity += link.body2->invMass * impulse;
+	link.body2->angularVelocity += link.body2->invI * cross(link.r2, impulse);
+}
+
+Rope::Rope() {
+	biasFactor = 0.2f;
+}
+
+void Rope::pin(Body* body, const Vec2& anchor) {
+	RopeLink link;
+	link.body1 = nullptr;
+	link.body2 = body;
+	link.localAnchor1 = anchor;
+	link.localAnchor2 = Mat22(body->rotation).transpose() * (anchor - body->position);
+	link.p.set(0.0f, 0.0f);
+	links.push_back(link);
+}
+
+void Rope::link(Body* body1, Body* body2, const Vec2& anchor) {
+	RopeLink link;
+	link.body1 = body1;
+	link.body2 = body2;
+	link.localAnchor1 = Mat22(body1->rotation).transpose() * (anchor - body1->position);
+	link.localAnchor2 = Mat22(body2->rotation).transpose() * (anchor - body2->position);
+	link.p.set(0.0f, 0.0f);
+	links.push_back(link);
+}
+
+void Rope::preStep(float invDt) {
+	int count = static_cast<int>(links.size());
+	for (int i = 0; i < count; ++i) {
+		RopeLink& link = links[i];
+
+		Vec2 p1;
+		if (link.body1 != nullptr) {
+			link.r1 = Mat22(link.body1->rotation) * link.localAnchor1;
+			p1 = link.body1->position + link.r1;
+		} else {
+			link.r1.set(0.0f, 0.0f);
+			p1 = link.localAnchor1;
+		}
+		link.r2 = Mat22(link.body2->rotation) * link.localAnchor2;
+		Vec2 p2 = link.body2->position + link.r2;
+
+		link.K = pointMass(link.body1, link.r1) + pointMass(link.body2, link.r2);
+
+		if (World::positionCorrection) {
+			link.bias = -biasFactor * invDt * (p2 - p1);
+		} else {
+			link.bias.set(0.0f, 0.0f);
+		}
+
+		if (World::warmStarting) {
+			applyLinkImpulse(link, link.p);
+		} else {
+			link.p.set(0.0f, 0.0f);
+		}
+	}
+
+	// Off-diagonal blocks: an impulse on the next link moves this one
+	// through the body they share
+	for (int i = 0; i < count; ++i) {
+		RopeLink& link = links[i];
+		link.B.col1.set(0.0f, 0.0f);
+		link.B.col2.set(0.0f, 0.0f);
+		if (i + 1 == count || links[i + 1].body1 != link.body2) {
+			continue;
+		}
+
+		const Body* shared = link.body2;
+		const Vec2& r2 = link.r2;
+		const Vec2& r1 = links[i + 1].r1;
+		link.B.col1.x = -shared->invMass - shared->invI * r1.y * r2.y;
+		link.B.col1.y = shared->invI * r1.y * r2.x;
+		link.B.col2.x = shared->invI * r1.x * r2.y;
+		link.B.col2.y = -shared->invMass - shared->invI * r1.x * r2.x;
+	}
+
+	// Block LDL^T factorization, done once per step and reused by every
+	// solve
+	for (int i = 0; i < count; ++i) {
+		RopeLink& link = links[i];
+		if (i == 0) {
+			link.L.col1.set(0.0f, 0.0f);
+			link.L.col2.set(0.0f, 0.0f);
+			link.invD = link.K.invert();
+			continue;
+		}
+
+		const RopeLink& previous = links[i - 1];
+		link.L = previous.B.transpose() * previous.invD;
+		Mat22 LB = link.L * previous.B;
+		Mat22 D;
+		D.col1 = link.K.col1 - LB.col1;
+		D.col2 = link.K.col2 - LB.col2;
+		link.invD = D.invert();
+	}
+}
+
+void Rope::applyImpulse() {
+	int count = static_cast<int>(links.size());
+	if (count == 0) {
+		return;
+	}
+
+	// Forward substitution
+	for (int i = 0; i < count; ++i) {
+		RopeLink& link = links[i];
+		Vec2 dv = pointVelocity(link.body2, link.r2) - pointVelocity(link.body1, link.r1);
+		// With split impulses the bias goes to the pseudo velocities instead
+		link.rhs = World::splitImpulse ? -dv : link.bias - dv;
+		if (i > 0) {
+			link.rhs -= link.L * links[i - 1].rhs;
+		}
+	}
+
+	// Back substitution leaves every link's impulse in rhs
+	links[count - 1].rhs = links[count - 1].invD * links[count - 1].rhs;
+	for (int i = count - 2; i >= 0; --i) {
+		links[i].rhs = links[i].invD * (links[i].rhs - links[i].B * links[i + 1].rhs);
+	}
+
+	for (auto& link : links) {
+		applyLinkImpulse(link, link.rhs);
+		link.p += link.rhs;
+	}
+}
+
+void Rope::applyBiasImpulse() {
+	int count = static_cast<int>(links.size());
+	if (count == 0) {
+		return;
+	}
+
+	// The same solve on the pseudo velocities, driven by the bias alone
+	for (int i = 0; i < count; ++i) {
+		RopeLink& link = links[i];
+		Vec2 dv = pointBiasVelocity(link.body2, link.r2) - pointBiasVelocity(link.body1, link.r1);
+		link.rhs = link.bias - dv;
+		if (i > 0) {
+			link.rhs -= link.L * links[i - 1].rhs;
+		}
+	}
+
+	links[count - 1].rhs = links[count - 1].invD * links[count - 1].rhs;
+	for (int i = count - 2; i >= 0; --i) {
+		links[i].rhs = links[i].invD * (links[i].rhs - links[i].B * links[i + 1].rhs);
+	}
+
+	for (auto& link : links) {
+		applyLinkBiasImpulse(link, link.rhs);
+	}
+}
+
+}
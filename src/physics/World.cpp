@@ -1,32 +1,84 @@
 #include "../../include/physics/World.hpp"
+#include <chrono>
 
 namespace physics {
 
-using std::map;
-using std::pair;
+typedef ArbiterMap::value_type ArbPair;
+typedef ArbiterMap::iterator ArbIter;
+typedef std::chrono::steady_clock StepClock;
 
-typedef pair<ArbiterKey, Arbiter> ArbPair;
-typedef map<ArbiterKey, Arbiter>::iterator ArbIter;
+static float elapsedMs(StepClock::time_point& since) {
+	StepClock::time_point now = StepClock::now();
+	float ms = std::chrono::duration<float, std::milli>(now - since).count();
+	since = now;
+	return ms;
+}
 
 bool World::accumulateImpulses = true;
-bool World::warmStarting = false;
+bool World::warmStarting = true;
 bool World::positionCorrection = true;
+bool World::blockSolver = true;
+bool World::splitImpulse = true;
 
-World::World() {}
+World::World() : nextSerial(0) {}
 
 void World::add(Body* body) {
 	body->id = bodies.size();
+	body->serial = nextSerial++;
 	bodies.emplace_back(body);
 }
 
+void World::add(Body* first, int count) {
+	bodies.reserve(bodies.size() + count);
+	for (int i = 0; i < count; ++i) {
+		first[i].id = bodies.size();
+		first[i].serial = nextSerial++;
+		bodies.emplace_back(first + i);
+	}
+}
+
 void World::add(Joint* joint) {
 	joints.emplace_back(joint);
 }
 
+void World::add(Rope* rope) {
+	ropes.emplace_back(rope);
+}
+
+void World::remove(Body* body) {
+	int id = body->id;
+	if (id < 0 || id >= (int)bodies.size() || bodies[id] != body) {
+		return;
+	}
+
+	bodies[id] = bodies.back();
+	bodies[id]->id = id;
+	bodies.pop_back();
+
+	for (ArbIter iter = arbiters.begin(); iter != arbiters.end();) {
+		if (iter->second.body1 == body || iter->second.body2 == body) {
+			iter = arbiters.erase(iter);
+		} else {
+			++iter;
+		}
+	}
+}
+
+void World::remove(Rope* rope) {
+	for (auto iter = ropes.begin(); iter != ropes.end(); ++iter) {
+		if (*iter == rope) {
+			ropes.erase(iter);
+			return;
+		}
+	}
+}
+
 void World::clear() {
 	bodies.clear();
 	joints.clear();
+	ropes.clear();
 	arbiters.clear();
+	nextSerial = 0;
 }
 
 void World::broadPhase() {
@@ -42,6 +94,10 @@ void World::broadPhase() {
 				continue;
 			}
 
+			if (bi->group != 0 && bi->group == bj->group) {
+				continue;
+			}
+
 			Arbiter newArb(bi, bj);
 			ArbiterKey key(bi, bj);
 
@@ -63,8 +119,10 @@ void World::broadPhase() {
 
 void World::step(float dt) {
 	float invDt = dt > 0.0f ? 1.0f / dt : 0.0f;
+	StepClock::time_point phase = StepClock::now();
 
 	broadPhase();
+	stats.broadPhaseMs = elapsedMs(phase);
 
 	for (auto& body : bodies) {
 		if (body->invMass == 0.0f) {
@@ -73,26 +131,34 @@ void World::step(float dt) {
 
 		body->velocity += dt * (gravity + body->invMass * body->force);
 	}
+	stats.integrateMs = elapsedMs(phase);
 
+	stats.contacts = 0;
 	for (auto& arb : arbiters) {
-		if (arb.second.contacts[0].position.x != arb.second.contacts[1].position.x) {
-			if (arb.second.contacts[0].position.y * 1.001 >= arb.second.body1->position.y + arb.second.body1->width.y / 2.0f) {
-				arb.second.body1->canJump = true;
-				arb.second.body1->friction = 2.0f;
-			}
-			if (arb.second.contacts[0].position.y * 1.001 >= arb.second.body2->position.y + arb.second.body2->width.y / 2.0f) {
-				arb.second.body2->canJump = true;
-				arb.second.body2->friction = 2.0f;
-			}
+		// A body stands on the other one when the contact normal points mostly
+		// down from it, whatever the shapes
+		float standing = arb.second.contacts[0].normal.y;
+		if (standing > 0.7f) {
+			arb.second.body1->canJump = true;
+			arb.second.body1->friction = 2.0f;
+		} else if (standing < -0.7f) {
+			arb.second.body2->canJump = true;
+			arb.second.body2->friction = 2.0f;
 		}
 
 		arb.second.preStep(invDt);
+		stats.contacts += arb.second.numContacts;
 	}
 
 	for (auto& joint : joints) {
 		joint->preStep(invDt);
 	}
 
+	for (auto& rope : ropes) {
+		rope->preStep(invDt);
+	}
+	stats.preStepMs = elapsedMs(phase);
+
 	for (int i = 0; i < iterations; ++i) {
 		for (auto& arb : arbiters) {
 			arb.second.applyImpulse();
@@ -101,15 +167,42 @@ void World::step(float dt) {
 		for (auto& joint : joints) {
 			joint->applyImpulse();
 		}
+
+		for (auto& rope : ropes) {
+			rope->applyImpulse();
+		}
 	}
 
+	if (splitImpulse) {
+		for (int i = 0; i < iterations; ++i) {
+			for (auto& arb : arbiters) {
+				arb.second.applyBiasImpulse();
+			}
+
+			for (auto& joint : joints) {
+				joint->applyBiasImpulse();
+			}
+
+			for (auto& rope : ropes) {
+				rope->applyBiasImpulse();
+			}
+		}
+	}
+	stats.solveMs = elapsedMs(phase);
+
 	for (auto& body : bodies) {
-		body->position += dt * body->velocity;
-		body->rotation += dt * body->angularVelocity;
+		body->position += dt * (body->velocity + body->biasVelocity);
+		body->rotation += dt * (body->angularVelocity + body->biasAngularVelocity);
+		body->biasVelocity.set(0.0f, 0.0f);
+		body->biasAngularVelocity = 0.0f;
 
 		body->force.set(0.0f, 0.0f);
 		body->torque = 0.0f;
 	}
+	stats.integrateMs += elapsedMs(phase);
+
+	stats.bodies = static_cast<int>(bodies.size());
+	stats.arbiters = static_cast<int>(arbiters.size());
 }
 
 }
@@ -0,0 +1,147 @@
+#include "../../include/render/AtlasBuilder.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace render {
+
+namespace {
+
+struct Shelf {
+	int y;
+	int height;
+	int cursor;
+};
+
+struct PageLayout {
+	std::vector<Shelf> shelves;
+	int usedWidth;
+	int usedHeight;
+};
+
+}
+
+AtlasBuilder::AtlasBuilder(int maxPageSize, int padding) {
+	this->maxPageSize = maxPageSize;
+	this->padding = padding;
+}
+
+int AtlasBuilder::add(const std::string& name, Image image) {
+	auto found = ids.find(name);
+	if (found != ids.end()) {
+		images[found->second] = std::move(image);
+		return found->second;
+	}
+
+	int id = static_cast<int>(images.size());
+	images.push_back(std::move(image));
+	names.push_back(name);
+	ids.emplace(name, id);
+	return id;
+}
+
+int AtlasBuilder::find(const std::string& name) const {
+	auto found = ids.find(name);
+	return found == ids.end() ? -1 : found->second;
+}
+
+void AtlasBuilder::build() {
+	std::vector<int> order(images.size());
+	for (int i = 0; i < static_cast<int>(order.size()); ++i) {
+		order[i] = i;
+	}
+	std::stable_sort(order.begin(), order.end(), [this](int a, int b) {
+		if (images[a].height != images[b].height) {
+			return images[a].height > images[b].height;
+		}
+		return images[a].width > images[b].width;
+	});
+
+	std::vector<PageLayout> layouts;
+	regions.assign(images.size(), AtlasRegion{ 0, 0, 0, 0, 0, UVRect{ 0.0f, 0.0f, 0.0f, 0.0f } });
+
+	for (int id : order) {
+		int w = images[id].width + 2 * padding;
+		int h = images[id].height + 2 * padding;
+		if (w > maxPageSize || h > maxPageSize || images[id].width == 0 || images[id].height == 0) {
+			continue;
+		}
+
+		int page = -1;
+		Shelf* target = nullptr;
+		for (int p = 0; p < static_cast<int>(layouts.size()) && !target; ++p) {
+			for (auto& shelf : layouts[p].shelves) {
+				if (h <= shelf.height && shelf.cursor + w <= maxPageSize) {
+					page = p;
+					target = &shelf;
+					break;
+				}
+			}
+			if (!target && layouts[p].usedHeight + h <= maxPageSize) {
+				layouts[p].shelves.push_back(Shelf{ layouts[p].usedHeight, h, 0 });
+				layouts[p].usedHeight += h;
+				page = p;
+				target = &layouts[p].shelves.back();
+			}
+		}
+		if (!target) {
+			layouts.push_back(PageLayout{ { Shelf{ 0, h, 0 } }, 0, h });
+			page = static_cast<int>(layouts.size()) - 1;
+			target = &layouts.back().shelves.back();
+		}
+
+		AtlasRegion& region = regions[id];
+		region.page = page;
+		region.x = target->cursor + padding;
+		region.y = target->y + padding;
+		region.width = images[id].width;
+		region.height = images[id].height;
+
+		target->cursor += w;
+		layouts[page].usedWidth = std::max(layouts[page].usedWidth, target->cursor);
+	}
+
+	pages.clear();
+	for (const auto& layout : layouts) {
+		pages.emplace_back(layout.usedWidth, layout.usedHeight);
+	}
+
+	for (int id = 0; id < static_cast<int>(images.size()); ++id) {
+		AtlasRegion& region = regions[id];
+		if (region.width == 0) {
+			continue;
+		}
+
+		Image& page = pages[region.page];
+		blit(page, images[id], region.x, region.y);
+
+		region.uv.u0 = static_cast<float>(region.x) / page.width;
+		region.uv.v0 = static_cast<float>(region.y) / page.height;
+		region.uv.u1 = static_cast<float>(region.x + region.width) / page.width;
+		region.uv.v1 = static_cast<float>(region.y + region.height) / page.height;
+	}
+
+	// The source pixels live in the pages now
+	for (auto& image : images) {
+		image.pixels.clear();
+		image.pixels.shrink_to_fit();
+	}
+}
+
+void AtlasBuilder::blit(Image& page, const Image& image, int x, int y) {
+	// Copy the image and extrude its border into the padding, so linear
+	// filtering never picks up texels of a neighbour.
+	size_t rowSize = static_cast<size_t>(image.width) * 4;
+	for (int row = -padding; row < image.height + padding; ++row) {
+		int sourceRow = std::min(std::max(row, 0), image.height - 1);
+		const uint8_t* source = image.pixels.data() + sourceRow * rowSize;
+		uint8_t* destination = page.pixels.data() + (static_cast<size_t>(y + row) * page.width + x) * 4;
+
+		std::memcpy(destination, source, rowSize);
+		for (int column = 1; column <= padding; ++column) {
+			std::memcpy(destination - column * 4, source, 4);
+			std::memcpy(destination + rowSize + (column - 1) * 4, source + rowSize - 4, 4);
+		}
+	}
+}
+
+}
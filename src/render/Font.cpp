@@ -0,0 +1,129 @@
+#include "../../include/render/Font.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace render {
+
+Font::Font() {
+	for (auto& glyph : metrics.glyphs) {
+		glyph = Glyph{ -1, 0, 0, 0 };
+	}
+	std::memset(metrics.kerning, 0, sizeof(metrics.kerning));
+	metrics.lineHeight = 0.0f;
+}
+
+void Font::rasterize(TTF_Font* font, const std::string& name, AtlasBuilder& builder) {
+	SDL_Color white{ 255, 255, 255, 255 };
+	metrics.lineHeight = static_cast<float>(TTF_FontHeight(font));
+
+	for (int c = FIRST_CHAR; c <= LAST_CHAR; ++c) {
+		Glyph& glyph = metrics.glyphs[c - FIRST_CHAR];
+
+		int minX, maxX, minY, maxY;
+		if (TTF_GlyphMetrics(font, static_cast<Uint16>(c), &minX, &maxX, &minY, &maxY, &glyph.advance) < 0) {
+			continue;
+		}
+
+		SDL_Surface* rendered = TTF_RenderGlyph_Blended(font, static_cast<Uint16>(c), white);
+		if (!rendered) {
+			continue;
+		}
+
+		// ARGB8888 is BGRA in memory on little-endian machines, which is the
+		// atlas layout.
+		SDL_Surface* surface = SDL_ConvertSurfaceFormat(rendered, SDL_PIXELFORMAT_ARGB8888, 0);
+		SDL_FreeSurface(rendered);
+		if (!surface) {
+			continue;
+		}
+
+		Image image(surface->w, surface->h);
+		SDL_LockSurface(surface);
+		for (int y = 0; y < surface->h; ++y) {
+			std::memcpy(image.pixels.data() + static_cast<size_t>(y) * surface->w * 4, static_cast<const uint8_t*>(surface->pixels) + y * surface->pitch, static_cast<size_t>(surface->w) * 4);
+		}
+		SDL_UnlockSurface(surface);
+
+		glyph.width = surface->w;
+		glyph.height = surface->h;
+		SDL_FreeSurface(surface);
+
+		glyph.region = builder.add(name + "/" + std::to_string(c), std::move(image));
+	}
+
+	for (int a = FIRST_CHAR; a <= LAST_CHAR; ++a) {
+		for (int b = FIRST_CHAR; b <= LAST_CHAR; ++b) {
+			int kern = TTF_GetFontKerningSizeGlyphs(font, static_cast<Uint16>(a), static_cast<Uint16>(b));
+			metrics.kerning[a - FIRST_CHAR][b - FIRST_CHAR] = static_cast<signed char>(std::min(std::max(kern, -128), 127));
+		}
+	}
+
+	cache.clear();
+}
+
+std::vector<uint8_t> Font::saveMetrics() const {
+	const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&metrics);
+	return std::vector<uint8_t>(bytes, bytes + sizeof(metrics));
+}
+
+bool Font::loadMetrics(const uint8_t* data, size_t size) {
+	if (size != sizeof(metrics)) {
+		return false;
+	}
+	std::memcpy(&metrics, data, sizeof(metrics));
+	cache.clear();
+	return true;
+}
+
+const TextLayout& Font::layout(const std::string& text) {
+	auto found = cache.find(text);
+	if (found != cache.end()) {
+		return found->second;
+	}
+
+	if (cache.size() >= MAX_CACHED) {
+		cache.clear();
+	}
+
+	TextLayout& result = cache[text];
+	result.quads.reserve(text.size());
+	result.width = 0.0f;
+	result.height = metrics.lineHeight;
+
+	float pen = 0.0f;
+	int previous = -1;
+	for (unsigned char c : text) {
+		if (c < FIRST_CHAR || c > LAST_CHAR) {
+			previous = -1;
+			continue;
+		}
+
+		int index = c - FIRST_CHAR;
+		if (previous >= 0) {
+			pen += metrics.kerning[previous][index];
+		}
+
+		const Glyph& glyph = metrics.glyphs[index];
+		if (glyph.region >= 0) {
+			result.quads.push_back(GlyphQuad{ glyph.region, pen, 0.0f, pen + glyph.width, static_cast<float>(glyph.height) });
+			result.width = std::max(result.width, pen + glyph.width);
+		}
+
+		pen += glyph.advance;
+		previous = index;
+	}
+	result.width = std::max(result.width, pen);
+
+	return result;
+}
+
+void Font::draw(SpriteBatch& batch, const TextureAtlas& atlas, const std::string& text, float x, float y, uint32_t color) {
+	const TextLayout& textLayout = layout(text);
+
+	for (const auto& quad : textLayout.quads) {
+		const AtlasRegion& region = atlas.getRegion(quad.region);
+		batch.draw(atlas.getTexture(region.page), x + quad.x0, y + quad.y0, x + quad.x1, y + quad.y1, region.uv, color);
+	}
+}
+
+}
@@ -0,0 +1,71 @@
+#include "../../include/render/Image.hpp"
+#include <FreeImage.h>
+#include <algorithm>
+#include <cstring>
+
+namespace render {
+
+bool loadImage(const char* fileName, Image& image) {
+	FREE_IMAGE_FORMAT format = FreeImage_GetFileType(fileName, 0);
+	if (format == FIF_UNKNOWN) {
+		format = FreeImage_GetFIFFromFilename(fileName);
+	}
+	if (format == FIF_UNKNOWN) {
+		return false;
+	}
+
+	FIBITMAP* source = FreeImage_Load(format, fileName);
+	if (!source) {
+		return false;
+	}
+
+	FIBITMAP* image32bits = FreeImage_ConvertTo32Bits(source);
+	FreeImage_Unload(source);
+	if (!image32bits) {
+		return false;
+	}
+
+	image = Image(FreeImage_GetWidth(image32bits), FreeImage_GetHeight(image32bits));
+
+	// FreeImage stores scanlines bottom-up
+	size_t rowSize = static_cast<size_t>(image.width) * 4;
+	for (int y = 0; y < image.height; ++y) {
+		std::memcpy(image.pixels.data() + y * rowSize, FreeImage_GetScanLine(image32bits, image.height - 1 - y), rowSize);
+	}
+
+	FreeImage_Unload(image32bits);
+	return true;
+}
+
+std::vector<Image> buildMipChain(const Image& base, int maxLevels) {
+	std::vector<Image> levels;
+	levels.reserve(maxLevels);
+	levels.push_back(base);
+
+	while (static_cast<int>(levels.size()) < maxLevels) {
+		const Image& source = levels.back();
+		if (source.width == 1 && source.height == 1) {
+			break;
+		}
+
+		Image level(std::max(1, source.width / 2), std::max(1, source.height / 2));
+		for (int y = 0; y < level.height; ++y) {
+			int y0 = std::min(y * 2, source.height - 1);
+			int y1 = std::min(y * 2 + 1, source.height - 1);
+			for (int x = 0; x < level.width; ++x) {
+				int x0 = std::min(x * 2, source.width - 1);
+				int x1 = std::min(x * 2 + 1, source.width - 1);
+				for (int c = 0; c < 4; ++c) {
+					int sum = source.pixels[(y0 * source.width + x0) * 4 + c] + source.pixels[(y0 * source.width + x1) * 4 + c]
+						+ source.pixels[(y1 * source.width + x0) * 4 + c] + source.pixels[(y1 * source.width + x1) * 4 + c];
+					level.pixels[(y * level.width + x) * 4 + c] = static_cast<uint8_t>((sum + 2) / 4);
+				}
+			}
+		}
+		levels.push_back(std::move(level));
+	}
+
+	return levels;
+}
+
+}
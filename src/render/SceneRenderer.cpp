@@ -0,0 +1,104 @@
+#include "../../include/render/SceneRenderer.hpp"
+#include <cmath>
+#include <cstdint>
+
+namespace render {
+
+SceneRenderer::SceneRenderer(SpriteBatch& batch, const TextureAtlas& atlas) : batch(batch), atlas(atlas) {
+	layerReady = false;
+	layerVersion = UINT64_MAX;
+
+	width = 0;
+	height = 0;
+	layerPages = 1;
+	backgroundSprite = -1;
+}
+
+void SceneRenderer::init(int width, int height, int layerPages) {
+	this->width = width;
+	this->height = height;
+	this->layerPages = layerPages;
+
+	layerReady = layer.init(width * layerPages, height);
+	layerVersion = UINT64_MAX;
+}
+
+void SceneRenderer::destroy() {
+	layer.destroy();
+	layerReady = false;
+}
+
+bool SceneRenderer::prepare(const RenderSnapshot& snapshot) {
+	if (!layerReady || snapshot.staticVersion == layerVersion) {
+		return false;
+	}
+
+	float layerWidth = static_cast<float>(width * layerPages);
+
+	layer.begin();
+	glMatrixMode(GL_PROJECTION);
+	glPushMatrix();
+	glLoadIdentity();
+	glOrtho(0, layerWidth, height, 0, -1, 1);
+	glMatrixMode(GL_MODELVIEW);
+	glLoadIdentity();
+
+	batch.begin();
+	drawStatic(snapshot, snapshot.staticOriginX, snapshot.staticOriginX + layerWidth, -snapshot.staticOriginX);
+	batch.end();
+
+	glMatrixMode(GL_PROJECTION);
+	glPopMatrix();
+	glMatrixMode(GL_MODELVIEW);
+	layer.end();
+
+	layerVersion = snapshot.staticVersion;
+	return true;
+}
+
+void SceneRenderer::draw(const RenderSnapshot& snapshot) {
+	glMatrixMode(GL_MODELVIEW);
+	glLoadIdentity();
+
+	// Level space to screen space
+	float offsetX = -snapshot.cameraX;
+
+	if (layerReady) {
+		float x0 = snapshot.staticOriginX + offsetX;
+		batch.draw(layer.getTexture(), x0, 0.0f, x0 + width * layerPages, height, UVRect{ RenderLayer::U0, RenderLayer::V0, RenderLayer::U1, RenderLayer::V1 });
+	} else {
+		drawStatic(snapshot, snapshot.cameraX, snapshot.cameraX + width, offsetX);
+	}
+
+	drawSprites(snapshot.sprites, offsetX);
+	drawParticles(snapshot.particles, offsetX);
+}
+
+void SceneRenderer::drawSprites(const std::vector<SpriteInstance>& sprites, float offsetX) {
+	for (const auto& sprite : sprites) {
+		const AtlasRegion& region = atlas.getRegion(sprite.spriteId);
+		batch.draw(atlas.getTexture(region.page), sprite.x0 + offsetX, sprite.y0, sprite.x1 + offsetX, sprite.y1, region.uv);
+	}
+}
+
+void SceneRenderer::drawParticles(const std::vector<ParticleInstance>& particles, float offsetX) {
+	for (const auto& particle : particles) {
+		const AtlasRegion& region = atlas.getRegion(particle.spriteId);
+		float half = particle.size / 2.0f;
+		batch.draw(atlas.getTexture(region.page), particle.x - half + offsetX, particle.y - half, particle.x + half + offsetX, particle.y + half, region.uv, particle.color);
+	}
+}
+
+void SceneRenderer::drawStatic(const RenderSnapshot& snapshot, float x0, float x1, float offsetX) {
+	// The background repeats every screen width
+	if (backgroundSprite >= 0) {
+		const AtlasRegion& background = atlas.getRegion(backgroundSprite);
+		for (float x = std::floor(x0 / width) * width; x < x1; x += width) {
+			batch.draw(atlas.getTexture(background.page), x + offsetX, 0.0f, x + width + offsetX, height, background.uv);
+		}
+	}
+
+	drawSprites(snapshot.staticSprites, offsetX);
+}
+
+}
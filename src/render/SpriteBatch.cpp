@@ -0,0 +1,139 @@
+#include "../../include/render/SpriteBatch.hpp"
+#include <cassert>
+#include <cstddef>
+
+namespace render {
+
+SpriteBatch::SpriteBatch(int maxSprites) {
+	// Indices are 16 bit
+	assert(maxSprites > 0 && maxSprites * 4 <= 65536);
+
+	this->maxSprites = maxSprites;
+	vertices.reserve(maxSprites * 4);
+	runs.reserve(64);
+
+	vertexBuffer = 0;
+	indexBuffer = 0;
+	boundTexture = 0;
+
+	drawCalls = 0;
+	textureBinds = 0;
+	spriteCount = 0;
+}
+
+SpriteBatch::~SpriteBatch() {
+	// GL objects are released by destroy() while the context is still alive
+}
+
+void SpriteBatch::init() {
+	std::vector<GLushort> indices(maxSprites * 6);
+	for (int i = 0; i < maxSprites; ++i) {
+		GLushort base = static_cast<GLushort>(i * 4);
+		indices[i * 6 + 0] = base;
+		indices[i * 6 + 1] = base + 1;
+		indices[i * 6 + 2] = base + 2;
+		indices[i * 6 + 3] = base;
+		indices[i * 6 + 4] = base + 2;
+		indices[i * 6 + 5] = base + 3;
+	}
+
+	glGenBuffers(1, &indexBuffer);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLushort), indices.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+	glGenBuffers(1, &vertexBuffer);
+	glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+	glBufferData(GL_ARRAY_BUFFER, maxSprites * 4 * sizeof(SpriteVertex), nullptr, GL_STREAM_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void SpriteBatch::destroy() {
+	if (vertexBuffer) {
+		glDeleteBuffers(1, &vertexBuffer);
+		vertexBuffer = 0;
+	}
+	if (indexBuffer) {
+		glDeleteBuffers(1, &indexBuffer);
+		indexBuffer = 0;
+	}
+}
+
+void SpriteBatch::begin() {
+	vertices.clear();
+	runs.clear();
+	boundTexture = 0;
+
+	drawCalls = 0;
+	textureBinds = 0;
+	spriteCount = 0;
+}
+
+void SpriteBatch::draw(GLuint texture, float x0, float y0, float x1, float y1, const UVRect& uv, uint32_t color) {
+	if (static_cast<int>(vertices.size()) == maxSprites * 4) {
+		flush();
+	}
+
+	int index = static_cast<int>(vertices.size()) / 4;
+	if (runs.empty() || runs.back().texture != texture) {
+		runs.push_back(Run{ texture, index, 0 });
+	}
+	++runs.back().count;
+	++spriteCount;
+
+	vertices.push_back(SpriteVertex{ x0, y0, uv.u0, uv.v0, color });
+	vertices.push_back(SpriteVertex{ x1, y0, uv.u1, uv.v0, color });
+	vertices.push_back(SpriteVertex{ x1, y1, uv.u1, uv.v1, color });
+	vertices.push_back(SpriteVertex{ x0, y1, uv.u0, uv.v1, color });
+}
+
+void SpriteBatch::end() {
+	flush();
+
+	glBindTexture(GL_TEXTURE_2D, 0);
+	boundTexture = 0;
+}
+
+void SpriteBatch::flush() {
+	if (vertices.empty()) {
+		return;
+	}
+
+	glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+	// Orphan the previous contents so the driver never waits on the GPU
+	glBufferData(GL_ARRAY_BUFFER, maxSprites * 4 * sizeof(SpriteVertex), nullptr, GL_STREAM_DRAW);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, vertices.size() * sizeof(SpriteVertex), vertices.data());
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	glEnableClientState(GL_COLOR_ARRAY);
+	glVertexPointer(2, GL_FLOAT, sizeof(SpriteVertex), reinterpret_cast<const void*>(offsetof(SpriteVertex, x)));
+	glTexCoordPointer(2, GL_FLOAT, sizeof(SpriteVertex), reinterpret_cast<const void*>(offsetof(SpriteVertex, u)));
+	glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(SpriteVertex), reinterpret_cast<const void*>(offsetof(SpriteVertex, color)));
+
+	for (const auto& run : runs) {
+		if (run.texture != boundTexture) {
+			glBindTexture(GL_TEXTURE_2D, run.texture);
+			boundTexture = run.texture;
+			++textureBinds;
+		}
+
+		glDrawElements(GL_TRIANGLES, run.count * 6, GL_UNSIGNED_SHORT, reinterpret_cast<const void*>(run.first * 6 * sizeof(GLushort)));
+		++drawCalls;
+	}
+
+	glDisableClientState(GL_COLOR_ARRAY);
+	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	glDisableClientState(GL_VERTEX_ARRAY);
+	// The current color is undefined after drawing with a color array
+	glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
+
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	vertices.clear();
+	runs.clear();
+}
+
+}
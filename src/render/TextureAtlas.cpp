@@ -0,0 +1,63 @@
+#include "../../include/render/TextureAtlas.hpp"
+
+namespace render {
+
+TextureAtlas::TextureAtlas() {}
+
+void TextureAtlas::upload(const AtlasBuilder& builder) {
+	destroy();
+
+	setRegions(builder.getRegions(), builder.getNames());
+
+	for (const auto& page : builder.getPages()) {
+		std::vector<Image> mips = buildMipChain(page, MIP_LEVELS);
+
+		TextureLevel levels[MIP_LEVELS];
+		for (size_t level = 0; level < mips.size(); ++level) {
+			levels[level] = TextureLevel{ mips[level].width, mips[level].height, mips[level].pixels.data() };
+		}
+		uploadPage(levels, static_cast<int>(mips.size()));
+	}
+}
+
+void TextureAtlas::uploadPage(const TextureLevel* levels, int levelCount) {
+	GLuint texture;
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_2D, texture);
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, levelCount > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levelCount - 1);
+
+	for (int level = 0; level < levelCount; ++level) {
+		glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA, levels[level].width, levels[level].height, 0, GL_BGRA, GL_UNSIGNED_BYTE, levels[level].pixels);
+	}
+
+	glBindTexture(GL_TEXTURE_2D, 0);
+	textures.push_back(texture);
+}
+
+void TextureAtlas::setRegions(std::vector<AtlasRegion> regions, std::vector<std::string> names) {
+	this->regions = std::move(regions);
+	this->names = std::move(names);
+}
+
+void TextureAtlas::destroy() {
+	if (!textures.empty()) {
+		glDeleteTextures(static_cast<GLsizei>(textures.size()), textures.data());
+		textures.clear();
+	}
+}
+
+int TextureAtlas::find(const std::string& name) const {
+	for (size_t i = 0; i < names.size(); ++i) {
+		if (names[i] == name) {
+			return static_cast<int>(i);
+		}
+	}
+	return -1;
+}
+
+}
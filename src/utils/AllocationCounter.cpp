@@ -0,0 +1,143 @@
+#include "../../include/utils/AllocationCounter.hpp"
+#include <cstdlib>
+#include <new>
+
+// Replaces all of the replaceable global allocation functions, so the counts
+// never rely on how the standard library forwards one form to another. Any
+// program that links this file counts every C++ allocation, which costs one
+// thread local increment each.
+
+namespace {
+
+thread_local AllocationCounts counts = { 0, 0, 0 };
+
+void* allocate(size_t size) {
+	++counts.allocations;
+	counts.bytes += size;
+	void* pointer = std::malloc(size ? size : 1);
+	if (!pointer) {
+		throw std::bad_alloc();
+	}
+	return pointer;
+}
+
+void* allocateAligned(size_t size, std::align_val_t alignment) {
+	++counts.allocations;
+	counts.bytes += size;
+	size_t align = static_cast<size_t>(alignment);
+	// aligned_alloc wants a multiple of the alignment
+	void* pointer = std::aligned_alloc(align, (size + align - 1) / align * align);
+	if (!pointer) {
+		throw std::bad_alloc();
+	}
+	return pointer;
+}
+
+void release(void* pointer) {
+	if (pointer) {
+		++counts.frees;
+		std::free(pointer);
+	}
+}
+
+}
+
+AllocationCounts threadAllocations() {
+	return counts;
+}
+
+void* operator new(size_t size) {
+	return allocate(size);
+}
+
+void* operator new[](size_t size) {
+	return allocate(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+	try {
+		return allocate(size);
+	} catch (const std::bad_alloc&) {
+		return nullptr;
+	}
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+	try {
+		return allocate(size);
+	} catch (const std::bad_alloc&) {
+		return nullptr;
+	}
+}
+
+void* operator new(size_t size, std::align_val_t alignment) {
+	return allocateAligned(size, alignment);
+}
+
+void* operator new[](size_t size, std::align_val_t alignment) {
+	return allocateAligned(size, alignment);
+}
+
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+	try {
+		return allocateAligned(size, alignment);
+	} catch (const std::bad_alloc&) {
+		return nullptr;
+	}
+}
+
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+	try {
+		return allocateAligned(size, alignment);
+	} catch (const std::bad_alloc&) {
+		return nullptr;
+	}
+}
+
+void operator delete(void* pointer) noexcept {
+	release(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+	release(pointer);
+}
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept {
+	release(pointer);
+}
+
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept {
+	release(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept {
+	release(pointer);
+}
+
+void operator delete[](void* pointer, size_t) noexcept {
+	release(pointer);
+}
+
+void operator delete(void* pointer, std::align_val_t) noexcept {
+	release(pointer);
+}
+
+void operator delete[](void* pointer, std::align_val_t) noexcept {
+	release(pointer);
+}
+
+void operator delete(void* pointer, size_t, std::align_val_t) noexcept {
+	release(pointer);
+}
+
+void operator delete[](void* pointer, size_t, std::align_val_t) noexcept {
+	release(pointer);
+}
+
+void operator delete(void* pointer, std::align_val_t, const std::nothrow_t&) noexcept {
+	release(pointer);
+}
+
+void operator delete[](void* pointer, std::align_val_t, const std::nothrow_t&) noexcept {
+	release(pointer);
+}
@@ -0,0 +1,145 @@
+#include "../../include/utils/AssetPack.hpp"
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+const char MAGIC[4] = { 'J', 'W', 'P', 'K' };
+
+uint64_t alignUp(uint64_t value) {
+	return (value + 15u) & ~static_cast<uint64_t>(15u);
+}
+
+}
+
+AssetPack::AssetPack() {
+	base = nullptr;
+	size = 0;
+	entries = nullptr;
+	entryCount = 0;
+}
+
+AssetPack::~AssetPack() {
+	close();
+}
+
+bool AssetPack::open(const std::string& fileName) {
+	close();
+
+	int fd = ::open(fileName.c_str(), O_RDONLY);
+	if (fd < 0) {
+		return false;
+	}
+
+	struct stat info;
+	if (fstat(fd, &info) < 0 || static_cast<size_t>(info.st_size) < sizeof(PackHeader)) {
+		::close(fd);
+		return false;
+	}
+
+	void* mapping = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	// The mapping keeps the file alive
+	::close(fd);
+	if (mapping == MAP_FAILED) {
+		return false;
+	}
+
+	base = static_cast<const uint8_t*>(mapping);
+	size = info.st_size;
+	// Everything in here is about to be read once, front to back
+	madvise(mapping, size, MADV_WILLNEED);
+
+	const PackHeader* header = reinterpret_cast<const PackHeader*>(base);
+	bool valid = std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) == 0 && header->version == VERSION
+		&& sizeof(PackHeader) + static_cast<uint64_t>(header->entryCount) * sizeof(PackEntry) <= size;
+	if (valid) {
+		entries = reinterpret_cast<const PackEntry*>(base + sizeof(PackHeader));
+		entryCount = header->entryCount;
+		for (uint32_t i = 0; i < entryCount && valid; ++i) {
+			valid = entries[i].offset <= size && entries[i].size <= size - entries[i].offset;
+		}
+	}
+
+	if (!valid) {
+		close();
+		return false;
+	}
+
+	return true;
+}
+
+void AssetPack::close() {
+	if (base) {
+		munmap(const_cast<uint8_t*>(base), size);
+	}
+	base = nullptr;
+	size = 0;
+	entries = nullptr;
+	entryCount = 0;
+}
+
+const PackEntry* AssetPack::find(const char* name) const {
+	for (uint32_t i = 0; i < entryCount; ++i) {
+		if (std::strncmp(entries[i].name, name, sizeof(entries[i].name)) == 0) {
+			return entries + i;
+		}
+	}
+	return nullptr;
+}
+
+void AssetPackWriter::add(const std::string& name, PACK_ENTRY type, const void* data, size_t size, uint32_t width, uint32_t height, uint32_t levels) {
+	PackEntry entry;
+	std::memset(&entry, 0, sizeof(entry));
+	std::strncpy(entry.name, name.c_str(), sizeof(entry.name) - 1);
+	entry.type = type;
+	entry.width = width;
+	entry.height = height;
+	entry.levels = levels;
+
+	entries.push_back(entry);
+	blobs.emplace_back();
+	append(data, size);
+}
+
+void AssetPackWriter::append(const void* data, size_t size) {
+	const uint8_t* bytes = static_cast<const uint8_t*>(data);
+	blobs.back().insert(blobs.back().end(), bytes, bytes + size);
+}
+
+bool AssetPackWriter::write(const std::string& fileName) const {
+	PackHeader header;
+	std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+	header.version = AssetPack::VERSION;
+	header.entryCount = static_cast<uint32_t>(entries.size());
+	header.reserved = 0;
+
+	std::vector<PackEntry> table = entries;
+	uint64_t offset = alignUp(sizeof(PackHeader) + table.size() * sizeof(PackEntry));
+	for (size_t i = 0; i < table.size(); ++i) {
+		table[i].offset = offset;
+		table[i].size = blobs[i].size();
+		offset = alignUp(offset + blobs[i].size());
+	}
+
+	FILE* file = std::fopen(fileName.c_str(), "wb");
+	if (!file) {
+		return false;
+	}
+
+	static const uint8_t zeros[16] = {};
+	bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+	ok = ok && (table.empty() || std::fwrite(table.data(), sizeof(PackEntry), table.size(), file) == table.size());
+
+	uint64_t written = sizeof(PackHeader) + table.size() * sizeof(PackEntry);
+	for (size_t i = 0; i < table.size() && ok; ++i) {
+		ok = std::fwrite(zeros, 1, table[i].offset - written, file) == table[i].offset - written;
+		ok = ok && (blobs[i].empty() || std::fwrite(blobs[i].data(), 1, blobs[i].size(), file) == blobs[i].size());
+		written = table[i].offset + blobs[i].size();
+	}
+
+	return std::fclose(file) == 0 && ok;
+}
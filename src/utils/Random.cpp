@@ -0,0 +1,122 @@
+#include "../../include/utils/Random.hpp"
+#include <atomic>
+#include <mutex>
+#include <random>
+
+Pcg32::Pcg32() : Pcg32(0x853c49e6748fea9bULL, 0xda3e39cb94b95bdbULL) {}
+
+Pcg32::Pcg32(uint64_t seed, uint64_t sequence) {
+	this->seed(seed, sequence);
+}
+
+void Pcg32::seed(uint64_t seed, uint64_t sequence) {
+	state = 0u;
+	increment = (sequence << 1u) | 1u;
+	next();
+	state += seed;
+	next();
+}
+
+int Pcg32::range(int min, int max) {
+	if (max <= min) {
+		return min;
+	}
+
+	// Lemire's nearly divisionless bounded integer
+	uint32_t span = static_cast<uint32_t>(max) - static_cast<uint32_t>(min) + 1u;
+	if (span == 0u) {
+		return static_cast<int>(next());
+	}
+
+	uint64_t m = static_cast<uint64_t>(next()) * span;
+	uint32_t low = static_cast<uint32_t>(m);
+	if (low < span) {
+		uint32_t threshold = -span % span;
+		while (low < threshold) {
+			m = static_cast<uint64_t>(next()) * span;
+			low = static_cast<uint32_t>(m);
+		}
+	}
+
+	// In unsigned, spans past INT_MAX would overflow a signed add
+	return static_cast<int>(static_cast<uint32_t>(min) + static_cast<uint32_t>(m >> 32));
+}
+
+void Pcg32::fill(uint32_t* out, size_t count) {
+	for (size_t i = 0; i < count; ++i) {
+		out[i] = next();
+	}
+}
+
+void Pcg32::fill(float* out, size_t count, float min, float max) {
+	float scale = (max - min) * (1.0f / 16777216.0f);
+	for (size_t i = 0; i < count; ++i) {
+		out[i] = min + static_cast<float>(next() >> 8) * scale;
+	}
+}
+
+namespace rng {
+
+namespace {
+
+std::atomic<uint64_t> globalSeed{0};
+std::atomic<uint32_t> generation{0};
+std::atomic<uint32_t> threadCount{0};
+std::once_flag defaultSeedFlag;
+
+uint64_t splitMix64(uint64_t x) {
+	x += 0x9e3779b97f4a7c15ULL;
+	x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+	return x ^ (x >> 31);
+}
+
+struct ThreadStreams {
+	Pcg32 generators[static_cast<int>(RNG_STREAM::COUNT)];
+	uint32_t threadIndex;
+	uint32_t generation;
+
+	ThreadStreams() : threadIndex(threadCount.fetch_add(1)), generation(0) {}
+};
+
+}
+
+void setSeed(uint64_t seed) {
+	globalSeed.store(seed);
+	generation.fetch_add(1);
+}
+
+uint64_t getSeed() {
+	std::call_once(defaultSeedFlag, [] {
+		if (generation.load() == 0) {
+			// Nobody asked for a fixed seed: draw one from the OS exactly once.
+			std::random_device rd;
+			setSeed((static_cast<uint64_t>(rd()) << 32) | rd());
+		}
+	});
+	return globalSeed.load();
+}
+
+Pcg32& stream(RNG_STREAM id) {
+	thread_local ThreadStreams streams;
+
+	// The generation is read before the seed. A setSeed in between then
+	// leaves the streams tagged with the old generation, so they reseed again
+	// on the next call, rather than holding the old seed for good.
+	getSeed();
+	uint32_t current = generation.load(std::memory_order_acquire);
+	if (streams.generation != current) {
+		uint64_t seed = globalSeed.load(std::memory_order_acquire);
+		for (int i = 0; i < static_cast<int>(RNG_STREAM::COUNT); ++i) {
+			// Levels come out the same whichever thread builds them
+			uint64_t thread = i == static_cast<int>(RNG_STREAM::LEVEL) ? 0u : streams.threadIndex;
+			uint64_t sequence = thread * static_cast<uint64_t>(RNG_STREAM::COUNT) + i;
+			streams.generators[i].seed(splitMix64(seed ^ splitMix64(sequence)), sequence);
+		}
+		streams.generation = current;
+	}
+
+	return streams.generators[static_cast<int>(id)];
+}
+
+}
@@ -0,0 +1,44 @@
+#include "../../include/utils/ThreadPool.hpp"
+
+ThreadPool::ThreadPool(unsigned threads) {
+	stopping = false;
+
+	if (threads == 0) {
+		// hardware_concurrency() may report 0 when it can't tell
+		unsigned hardware = std::thread::hardware_concurrency();
+		threads = hardware > 1 ? hardware - 1 : 1;
+	}
+
+	workers.reserve(threads);
+	for (unsigned i = 0; i < threads; ++i) {
+		workers.emplace_back(&ThreadPool::run, this);
+	}
+}
+
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	available.notify_all();
+
+	for (auto& worker : workers) {
+		worker.join();
+	}
+}
+
+void ThreadPool::run() {
+	for (;;) {
+		std::function<void()> job;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			available.wait(lock, [this] { return stopping || !jobs.empty(); });
+			if (jobs.empty()) {
+				return;
+			}
+			job = std::move(jobs.front());
+			jobs.pop();
+		}
+		job();
+	}
+}
@@ -0,0 +1,63 @@
+#include "../include/Assets.hpp"
+#include <SDL2/SDL_ttf.h>
+#include <iostream>
+
+// Offline half of the asset pipeline: decodes every sprite, rasterizes the
+// fonts, packs the atlas and writes it, mip levels included, to one file the
+// game maps at startup, along with the compiled levels.
+int main(int argc, char** argv) {
+	if (argc != 3) {
+		std::cerr << "usage: " << argv[0] << " <assets directory> <output pack>" << std::endl;
+		return 2;
+	}
+
+	std::string assets = argv[1];
+	std::string output = argv[2];
+
+	if (TTF_Init() < 0) {
+		std::cerr << "TTF_Init failed: " << SDL_GetError() << std::endl;
+		return 1;
+	}
+
+	render::AtlasBuilder builder(4096);
+	render::Font menuFont;
+	render::Font hudFont;
+
+	if (!rasterizeFonts(assets + "/fonts/tarzan-regular.ttf", builder, menuFont, hudFont)) {
+		std::cerr << "Could not open " << assets << "/fonts/tarzan-regular.ttf" << std::endl;
+		TTF_Quit();
+		return 1;
+	}
+
+	int sprites = 0;
+	for (const auto& file : listSprites(assets + "/sprites")) {
+		render::Image image;
+		if (!render::loadImage(file.string().c_str(), image)) {
+			std::cerr << "Could not decode " << file << std::endl;
+			TTF_Quit();
+			return 1;
+		}
+		builder.add(file.stem().string(), std::move(image));
+		++sprites;
+	}
+	addBuiltinSprites(builder);
+	builder.build();
+
+	TTF_Quit();
+
+	std::vector<CompiledLevel> levels;
+	std::string error;
+	if (!compileLevels(assets + "/levels", levels, error)) {
+		std::cerr << error << std::endl;
+		return 1;
+	}
+
+	if (!writeAssetPack(builder, menuFont, hudFont, levels, output)) {
+		std::cerr << "Could not write " << output << std::endl;
+		return 1;
+	}
+
+	std::cout << "Packed " << sprites << " sprites and " << builder.getRegions().size() - sprites << " glyphs/builtins into "
+		<< builder.getPages().size() << " page(s), and " << levels.size() << " level(s): " << output << std::endl;
+	return 0;
+}
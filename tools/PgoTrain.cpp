@@ -0,0 +1,211 @@
+#include "../include/Assets.hpp"
+#include "../include/Game.hpp"
+#include "../include/physics/World.hpp"
+#include "../include/utils/AllocationCounter.hpp"
+#include "../include/utils/Random.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Training run for profile-guided builds, and the step time report that
+// compares them. Replays recorded sessions through the game's own tick,
+// Game::Logic and World::step included, without a window, then runs physics
+// stress scenes through World::step alone. tools/pgo.sh drives it. Fails if
+// a steady replayed tick, one without a reset or chunks streaming, allocated
+// on the heap.
+
+namespace {
+
+const float TICK = 1 / 60.0f;
+// Played on after the last recorded event
+const int TAIL_TICKS = 120;
+const int STRESS_TICKS = 600;
+
+struct SceneResult {
+	std::string name;
+	int ticks;
+	double meanMs;
+	double p99Ms;
+	int steadyTicks;
+	int allocatingTicks;
+};
+
+SceneResult summarize(const std::string& name, std::vector<double>& ms) {
+	double sum = 0.0;
+	for (double sample : ms) {
+		sum += sample;
+	}
+	SceneResult result{ name, static_cast<int>(ms.size()), ms.empty() ? 0.0 : sum / ms.size(), 0.0, 0, 0 };
+	if (!ms.empty()) {
+		size_t k = std::min(ms.size() - 1, static_cast<size_t>(0.99 * ms.size()));
+		std::nth_element(ms.begin(), ms.begin() + k, ms.end());
+		result.p99Ms = ms[k];
+	}
+	return result;
+}
+
+// False if the file cannot be read or has no seed line: without the seed the
+// input would replay on different levels than it was recorded on
+bool loadRecording(const std::filesystem::path& file, uint64_t& seed, std::vector<InputRecord>& records) {
+	FILE* in = std::fopen(file.string().c_str(), "r");
+	if (!in) {
+		return false;
+	}
+
+	bool seeded = false;
+	char line[128];
+	while (std::fgets(line, sizeof(line), in)) {
+		unsigned long long recordedSeed;
+		unsigned long long tick;
+		unsigned input;
+		int pressed;
+		if (line[0] == '#') {
+			continue;
+		}
+		if (std::sscanf(line, "seed %llu", &recordedSeed) == 1) {
+			seed = recordedSeed;
+			seeded = true;
+			continue;
+		}
+		if (std::sscanf(line, "%llu %u %d", &tick, &input, &pressed) != 3) {
+			continue;
+		}
+		records.push_back(InputRecord{ tick, input, pressed != 0 });
+	}
+	std::fclose(in);
+
+	std::stable_sort(records.begin(), records.end(), [](const InputRecord& a, const InputRecord& b) {
+		return a.tick < b.tick;
+	});
+	return seeded;
+}
+
+SceneResult replay(Game& game, const std::string& name, uint64_t seed, const std::vector<InputRecord>& records) {
+	typedef std::chrono::steady_clock clock;
+
+	// The levels the session was recorded on
+	rng::setSeed(seed);
+	game.ResetGame(true);
+
+	uint64_t ticks = (records.empty() ? 0 : records.back().tick) + TAIL_TICKS;
+	std::vector<double> ms;
+	ms.reserve(ticks);
+	int steadyTicks = 0;
+	int allocatingTicks = 0;
+	size_t next = 0;
+	for (uint64_t tick = 0; tick < ticks; ++tick) {
+		while (next < records.size() && records[next].tick <= tick) {
+			game.PushInput(records[next].input, records[next].pressed);
+			++next;
+		}
+
+		uint64_t version = game.LevelVersion();
+		AllocationScope tickScope;
+		auto start = clock::now();
+		game.PlayTick();
+		ms.push_back(std::chrono::duration<double, std::milli>(clock::now() - start).count());
+
+		// The first tick fills the reserved capacities
+		if (tick > 0 && game.LevelVersion() == version) {
+			++steadyTicks;
+			if (tickScope.allocations()) {
+				++allocatingTicks;
+			}
+		}
+	}
+
+	SceneResult result = summarize("replay/" + name, ms);
+	result.steadyTicks = steadyTicks;
+	result.allocatingTicks = allocatingTicks;
+	return result;
+}
+
+// A pyramid of boxes on the ground, like the classic stacking test: many
+// resting contacts, every pair through the broad phase
+SceneResult pyramid(int rows) {
+	typedef std::chrono::steady_clock clock;
+
+	physics::World world(physics::Vec2(0.0f, 9.81f), 10);
+	std::vector<std::unique_ptr<physics::Body>> bodies;
+
+	bodies.emplace_back(new physics::Body());
+	bodies.back()->set(physics::Vec2(100.0f, 20.0f), FLT_MAX);
+	bodies.back()->position.set(0.0f, 10.0f);
+	world.add(bodies.back().get());
+
+	for (int row = 0; row < rows; ++row) {
+		for (int column = 0; column < rows - row; ++column) {
+			bodies.emplace_back(new physics::Body());
+			physics::Body* box = bodies.back().get();
+			box->set(physics::Vec2(1.0f, 1.0f), 10.0f);
+			box->friction = 0.2f;
+			box->position.set((column - (rows - row) / 2.0f) * 1.125f, -0.5f - row * 1.05f);
+			world.add(box);
+		}
+	}
+
+	std::vector<double> ms;
+	ms.reserve(STRESS_TICKS);
+	for (int tick = 0; tick < STRESS_TICKS; ++tick) {
+		auto start = clock::now();
+		world.step(TICK);
+		ms.push_back(std::chrono::duration<double, std::milli>(clock::now() - start).count());
+	}
+
+	return summarize("stress/pyramid-" + std::to_string(rows), ms);
+}
+
+}
+
+int main(int argc, char** argv) {
+	std::string trainingDir = argc > 1 ? argv[1] : PGO_TRAINING_DIR;
+
+	std::vector<std::filesystem::path> files;
+	std::error_code error;
+	for (const auto& entry : std::filesystem::directory_iterator(trainingDir, error)) {
+		if (entry.is_regular_file() && entry.path().extension() == ".rec") {
+			files.push_back(entry.path());
+		}
+	}
+	std::sort(files.begin(), files.end());
+	if (files.empty()) {
+		std::fprintf(stderr, "No recordings in %s\n", trainingDir.c_str());
+		return 1;
+	}
+
+	Game game(1280, 720);
+	StageTimer timer("Training");
+	if (!game.LoadLevels(timer)) {
+		return 1;
+	}
+
+	std::vector<SceneResult> results;
+	for (const auto& file : files) {
+		uint64_t seed = 0;
+		std::vector<InputRecord> records;
+		if (!loadRecording(file, seed, records)) {
+			std::fprintf(stderr, "Could not read a seed and input from %s\n", file.string().c_str());
+			return 1;
+		}
+		results.push_back(replay(game, file.stem().string(), seed, records));
+	}
+	for (int rows : { 10, 20, 30 }) {
+		results.push_back(pyramid(rows));
+	}
+
+	// Parsed by tools/pgo.sh
+	std::printf("%-24s %8s %10s %10s\n", "scene", "ticks", "mean ms", "p99 ms");
+	bool allocated = false;
+	for (const auto& result : results) {
+		std::printf("%-24s %8d %10.4f %10.4f\n", result.name.c_str(), result.ticks, result.meanMs, result.p99Ms);
+		if (result.allocatingTicks) {
+			std::fprintf(stderr, "%s: %d of %d steady ticks allocated\n", result.name.c_str(), result.allocatingTicks, result.steadyTicks);
+			allocated = true;
+		}
+	}
+	return allocated ? 1 : 0;
+}
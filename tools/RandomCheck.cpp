@@ -0,0 +1,94 @@
+#include "../include/utils/Random.hpp"
+#include <climits>
+#include <cstdio>
+#include <thread>
+
+// Checks Pcg32::range(int, int) at the extremes of int: every draw stays in
+// bounds, and spans wider than INT_MAX still cover both halves. Also checks
+// that a seed gives the same LEVEL sequence on any thread, as recorded
+// sessions replayed by tools/PgoTrain.cpp rely on.
+
+namespace {
+
+const int DRAWS = 100000;
+
+struct Bounds {
+	int min;
+	int max;
+};
+
+bool check(Pcg32& random, Bounds bounds) {
+	uint32_t span = static_cast<uint32_t>(bounds.max) - static_cast<uint32_t>(bounds.min);
+	bool lowHalf = false;
+	bool highHalf = false;
+	bool hitMin = false;
+	bool hitMax = false;
+	for (int i = 0; i < DRAWS; ++i) {
+		int value = random.range(bounds.min, bounds.max);
+		if (value < bounds.min || value > bounds.max) {
+			std::fprintf(stderr, "range(%d, %d) gave %d\n", bounds.min, bounds.max, value);
+			return false;
+		}
+		uint32_t offset = static_cast<uint32_t>(value) - static_cast<uint32_t>(bounds.min);
+		lowHalf |= offset < span / 2u;
+		highHalf |= offset > span / 2u;
+		hitMin |= value == bounds.min;
+		hitMax |= value == bounds.max;
+	}
+
+	// Narrow spans must reach both ends, wide ones both halves
+	if (span < 16u && !(hitMin && hitMax)) {
+		std::fprintf(stderr, "range(%d, %d) never reached an end\n", bounds.min, bounds.max);
+		return false;
+	}
+	if (span > static_cast<uint32_t>(INT_MAX) && !(lowHalf && highHalf)) {
+		std::fprintf(stderr, "range(%d, %d) stayed in one half\n", bounds.min, bounds.max);
+		return false;
+	}
+	return true;
+}
+
+}
+
+int main() {
+	Pcg32 random(42u, 54u);
+
+	const Bounds cases[] = {
+		{ INT_MIN, INT_MAX },
+		{ -2, INT_MAX },
+		{ INT_MIN, INT_MAX - 1 },
+		{ INT_MIN, 1 },
+		{ INT_MAX - 3, INT_MAX },
+		{ INT_MIN, INT_MIN + 3 },
+		{ -1, 1 },
+	};
+
+	bool passed = true;
+	for (const Bounds& bounds : cases) {
+		passed &= check(random, bounds);
+	}
+
+	// An empty or reversed range gives its minimum
+	if (random.range(7, 7) != 7 || random.range(7, 3) != 7) {
+		std::fprintf(stderr, "range(7, 7) or range(7, 3) did not give 7\n");
+		passed = false;
+	}
+
+	rng::setSeed(1234u);
+	uint32_t mainLevel = rng::stream(RNG_STREAM::LEVEL).next();
+	uint32_t workerLevel = 0u;
+	std::thread worker([&workerLevel] {
+		workerLevel = rng::stream(RNG_STREAM::LEVEL).next();
+	});
+	worker.join();
+	if (mainLevel != workerLevel) {
+		std::fprintf(stderr, "LEVEL stream differs between threads\n");
+		passed = false;
+	}
+
+	if (!passed) {
+		return 1;
+	}
+	std::printf("Random ranges and streams ok\n");
+	return 0;
+}
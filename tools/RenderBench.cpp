@@ -0,0 +1,304 @@
+#include "../include/render/AtlasBuilder.hpp"
+#include "../include/render/RenderLayer.hpp"
+#include "../include/render/SceneRenderer.hpp"
+#include "../include/render/SpriteBatch.hpp"
+#include "../include/render/TextureAtlas.hpp"
+#include "../include/utils/Random.hpp"
+#include "../include/utils/RollingStats.hpp"
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <GL/gl.h>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+// Renders scripted scenes through the same SceneRenderer as the game, into an
+// offscreen target of a surfaceless EGL context, so it runs on any Linux box,
+// a software rasterizer included. Reports the CPU time spent submitting each
+// frame and the GL work it issued.
+
+namespace {
+
+const int WIDTH = 1280;
+const int HEIGHT = 720;
+const int LAYER_PAGES = 2;
+const int WARMUP_FRAMES = 30;
+const int DEFAULT_FRAMES = 120;
+// Screens of level the static sprites are spread over
+const int LEVEL_PAGES = 8;
+// Level pixels the camera pans per frame
+const float PAN_SPEED = 24.0f;
+
+struct Sprites {
+	int background;
+	int tree;
+	int branch;
+	int character;
+	int fruit;
+};
+
+bool createContext(EGLDisplay& display, EGLContext& context) {
+	display = EGL_NO_DISPLAY;
+	auto getPlatformDisplay = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(eglGetProcAddress("eglGetPlatformDisplayEXT"));
+	if (getPlatformDisplay) {
+		display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+	}
+	if (display == EGL_NO_DISPLAY) {
+		display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+	}
+
+	EGLint major, minor;
+	if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor)) {
+		return false;
+	}
+
+	// The sprite batch uses the fixed function pipeline, so desktop GL
+	if (!eglBindAPI(EGL_OPENGL_API)) {
+		return false;
+	}
+
+	EGLint attributes[] = { EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE };
+	EGLConfig config = nullptr;
+	EGLint configCount = 0;
+	eglChooseConfig(display, attributes, &config, 1, &configCount);
+
+	context = eglCreateContext(display, configCount ? config : nullptr, EGL_NO_CONTEXT, nullptr);
+	if (context == EGL_NO_CONTEXT) {
+		return false;
+	}
+	return eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context);
+}
+
+render::Image solidImage(int width, int height, uint8_t r, uint8_t g, uint8_t b) {
+	render::Image image(width, height);
+	for (size_t i = 0; i < image.pixels.size(); i += 4) {
+		image.pixels[i + 0] = b;
+		image.pixels[i + 1] = g;
+		image.pixels[i + 2] = r;
+		image.pixels[i + 3] = 255;
+	}
+	return image;
+}
+
+// Stand-ins with the sizes of the game's sprites, so the atlas has the same
+// shape without decoding any file.
+Sprites buildAtlas(render::TextureAtlas& atlas) {
+	render::AtlasBuilder builder;
+	Sprites sprites;
+	sprites.background = builder.add("background", solidImage(WIDTH, HEIGHT, 40, 120, 60));
+	sprites.tree = builder.add("tree", solidImage(WIDTH / 12, HEIGHT, 90, 60, 20));
+	sprites.branch = builder.add("branch", solidImage(WIDTH / 6, HEIGHT / 20, 110, 80, 30));
+	sprites.character = builder.add("character", solidImage(68, 116, 200, 150, 100));
+	sprites.fruit = builder.add("fruit", solidImage(68, 68, 230, 200, 40));
+	builder.build();
+	atlas.upload(builder);
+	return sprites;
+}
+
+struct Scene {
+	// Level space
+	std::vector<render::SpriteInstance> staticSprites;
+	std::vector<render::SpriteInstance> movingSprites;
+	std::vector<float> phases;
+	// Keeps the static layer of one scene from being taken for another's
+	uint64_t versionBase;
+};
+
+// A quarter of the bodies are fixed branches and trees spread over the
+// level, the rest move around the view.
+Scene buildScene(const Sprites& sprites, int bodyCount, uint64_t seed) {
+	Pcg32 random(seed, static_cast<uint64_t>(bodyCount));
+	Scene scene;
+	scene.versionBase = static_cast<uint64_t>(bodyCount) << 32;
+	int staticCount = bodyCount / 4;
+
+	for (int i = 0; i < staticCount; ++i) {
+		bool tree = i % 8 == 0;
+		float w = tree ? WIDTH / 12.5f : WIDTH / 6.25f;
+		float h = tree ? static_cast<float>(HEIGHT) : HEIGHT / 20.0f;
+		float x = random.range(0.0f, static_cast<float>(WIDTH * LEVEL_PAGES));
+		float y = tree ? HEIGHT / 2.0f : random.range(h, HEIGHT - h);
+		scene.staticSprites.push_back(render::SpriteInstance{ tree ? sprites.tree : sprites.branch, x - w / 2, y - h / 2, x + w / 2, y + h / 2 });
+	}
+
+	const int moving[] = { sprites.character, sprites.fruit, sprites.branch };
+	for (int i = staticCount; i < bodyCount; ++i) {
+		float x = random.range(0.0f, static_cast<float>(WIDTH));
+		float y = random.range(0.0f, static_cast<float>(HEIGHT));
+		scene.movingSprites.push_back(render::SpriteInstance{ moving[i % 3], x - 34, y - 34, x + 34, y + 34 });
+		scene.phases.push_back(random.range(0.0f, 6.2831853f));
+	}
+
+	return scene;
+}
+
+// What PublishRenderState hands over for the given frame: the camera pans
+// along the level, static sprites are culled to the layer, moving ones
+// follow the camera.
+void fillSnapshot(const Scene& scene, int frame, render::RenderSnapshot& snapshot) {
+	float levelWidth = static_cast<float>(WIDTH * LEVEL_PAGES);
+	float cameraX = std::fmod(frame * PAN_SPEED, levelWidth - WIDTH);
+	int page = static_cast<int>(cameraX / WIDTH);
+
+	snapshot.cameraX = cameraX;
+	snapshot.staticOriginX = page * static_cast<float>(WIDTH);
+	snapshot.staticVersion = scene.versionBase + static_cast<uint64_t>(page);
+	snapshot.tick = static_cast<uint64_t>(frame);
+
+	float layerX1 = snapshot.staticOriginX + WIDTH * LAYER_PAGES;
+	snapshot.staticSprites.clear();
+	for (const auto& sprite : scene.staticSprites) {
+		if (sprite.x1 > snapshot.staticOriginX && sprite.x0 < layerX1) {
+			snapshot.staticSprites.push_back(sprite);
+		}
+	}
+
+	snapshot.sprites.clear();
+	for (size_t i = 0; i < scene.movingSprites.size(); ++i) {
+		render::SpriteInstance sprite = scene.movingSprites[i];
+		float dx = cameraX + 40.0f * std::sin(frame * 0.05f + scene.phases[i]);
+		float dy = 20.0f * std::cos(frame * 0.07f + scene.phases[i]);
+		sprite.x0 += dx;
+		sprite.x1 += dx;
+		sprite.y0 += dy;
+		sprite.y1 += dy;
+		snapshot.sprites.push_back(sprite);
+	}
+}
+
+struct SceneResult {
+	RollingStats submitMs;
+	RollingStats frameMs;
+	double drawCalls;
+	double textureBinds;
+	double sprites;
+	int layerRedraws;
+};
+
+SceneResult run(const Scene& scene, render::SceneRenderer& renderer, render::SpriteBatch& batch, render::RenderLayer& target, int frames) {
+	typedef std::chrono::steady_clock clock;
+
+	SceneResult result{ RollingStats(), RollingStats(), 0.0, 0.0, 0.0, 0 };
+	render::RenderSnapshot snapshot;
+
+	for (int frame = -WARMUP_FRAMES; frame < frames; ++frame) {
+		fillSnapshot(scene, frame + WARMUP_FRAMES, snapshot);
+
+		auto start = clock::now();
+
+		int drawCalls = 0;
+		int textureBinds = 0;
+		bool redrawn = renderer.prepare(snapshot);
+		if (redrawn) {
+			drawCalls += batch.getDrawCalls();
+			textureBinds += batch.getTextureBinds();
+		}
+
+		target.begin();
+		batch.begin();
+		renderer.draw(snapshot);
+		batch.end();
+		target.end();
+
+		auto submitted = clock::now();
+		// Keep the queue from growing, outside of the submission time
+		glFinish();
+		auto finished = clock::now();
+
+		if (frame < 0) {
+			continue;
+		}
+
+		result.submitMs.add(std::chrono::duration<double, std::milli>(submitted - start).count());
+		result.frameMs.add(std::chrono::duration<double, std::milli>(finished - start).count());
+		result.drawCalls += drawCalls + batch.getDrawCalls();
+		result.textureBinds += textureBinds + batch.getTextureBinds();
+		result.sprites += batch.getSpriteCount();
+		result.layerRedraws += redrawn ? 1 : 0;
+	}
+
+	result.drawCalls /= frames;
+	result.textureBinds /= frames;
+	result.sprites /= frames;
+	return result;
+}
+
+}
+
+int main(int argc, char** argv) {
+	int frames = argc > 1 ? std::atoi(argv[1]) : DEFAULT_FRAMES;
+	if (frames <= 0 || frames > RollingStats::CAPACITY) {
+		std::fprintf(stderr, "usage: %s [frames, 1 to %d]\n", argv[0], static_cast<int>(RollingStats::CAPACITY));
+		return 2;
+	}
+
+	EGLDisplay display;
+	EGLContext context;
+	if (!createContext(display, context)) {
+		std::fprintf(stderr, "Could not create a surfaceless GL context (EGL error 0x%x)\n", eglGetError());
+		return 1;
+	}
+	std::printf("%s, %s\n\n", glGetString(GL_RENDERER), glGetString(GL_VERSION));
+
+	// Same state as Game::OnInit
+	glEnable(GL_COLOR_MATERIAL);
+	glEnable(GL_TEXTURE_2D);
+	glEnable(GL_BLEND);
+	glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+	glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
+	glMatrixMode(GL_PROJECTION);
+	glLoadIdentity();
+	glOrtho(0, WIDTH, HEIGHT, 0, -1, 1);
+	glMatrixMode(GL_MODELVIEW);
+	glLoadIdentity();
+
+	render::TextureAtlas atlas;
+	Sprites sprites = buildAtlas(atlas);
+
+	render::SpriteBatch batch;
+	batch.init();
+
+	render::SceneRenderer renderer(batch, atlas);
+	renderer.init(WIDTH, HEIGHT, LAYER_PAGES);
+	renderer.setBackground(sprites.background);
+
+	// Stands in for the window's default framebuffer
+	render::RenderLayer target;
+	if (!target.init(WIDTH, HEIGHT) || !renderer.isLayerReady()) {
+		std::fprintf(stderr, "Framebuffer objects are not supported\n");
+		return 1;
+	}
+
+	std::printf("%8s %10s %10s %10s %10s %10s %10s %8s\n", "bodies", "submit ms", "p99 ms", "frame ms", "sprites", "draws", "binds", "layers");
+
+	// A software rasterizer needs about a second per frame beyond these
+	const int bodyCounts[] = { 8, 64, 512, 4096 };
+	bool failed = false;
+	for (int bodyCount : bodyCounts) {
+		Scene scene = buildScene(sprites, bodyCount, 1);
+		SceneResult result = run(scene, renderer, batch, target, frames);
+
+		std::printf("%8d %10.3f %10.3f %10.3f %10.0f %10.2f %10.2f %8d\n", bodyCount, result.submitMs.mean(), result.submitMs.percentile(0.99), result.frameMs.mean(), result.sprites, result.drawCalls, result.textureBinds, result.layerRedraws);
+
+		if (glGetError() != GL_NO_ERROR) {
+			failed = true;
+		}
+	}
+
+	target.destroy();
+	renderer.destroy();
+	batch.destroy();
+	atlas.destroy();
+
+	eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+	eglDestroyContext(display, context);
+	eglTerminate(display);
+
+	if (failed) {
+		std::fprintf(stderr, "GL errors while rendering\n");
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,202 @@
+#include "../include/Assets.hpp"
+#include "../include/Components.hpp"
+#include "../include/Level.hpp"
+#include "../include/ecs/Registry.hpp"
+#include "../include/physics/World.hpp"
+#include "../include/utils/AllocationCounter.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+// Runs the simulation side of the game headless over every level: the
+// camera pans along the level streaming chunks in and out, while the player
+// runs and jumps in view. Reports the step times, and fails if a steady tick,
+// one without chunks streaming, allocated anything on the heap. The hash
+// covers every body's state after every step: builds with DETERMINISTIC on
+// must print the same hashes on any machine.
+
+namespace {
+
+const int WIDTH = 1280;
+const int HEIGHT = 720;
+// Same as Game
+const int STATIC_LAYER_PAGES = 2;
+const float TICK = 1 / 60.0f;
+const int DEFAULT_TICKS = 600;
+// Level pixels the camera pans per tick
+const float PAN_SPEED = 16.0f;
+
+struct LevelResult {
+	double stepMs;
+	double stepP99Ms;
+	int maxBodies;
+	int maxArbiters;
+	int steadyTicks;
+	int allocatingTicks;
+	uint64_t allocations;
+	uint64_t hash;
+};
+
+// FNV-1a over the bits of the floats
+void hashState(uint64_t& hash, const float* values, int count) {
+	for (int i = 0; i < count; ++i) {
+		uint32_t bits;
+		std::memcpy(&bits, values + i, sizeof(bits));
+		for (int byte = 0; byte < 4; ++byte) {
+			hash = (hash ^ ((bits >> (8 * byte)) & 0xff)) * 0x100000001b3ULL;
+		}
+	}
+}
+
+double percentile(std::vector<double>& samples, double p) {
+	if (samples.empty()) {
+		return 0.0;
+	}
+	size_t k = std::min(samples.size() - 1, static_cast<size_t>(p * samples.size()));
+	std::nth_element(samples.begin(), samples.begin() + k, samples.end());
+	return samples[k];
+}
+
+LevelResult run(const LevelData& data, int ticks) {
+	typedef std::chrono::steady_clock clock;
+
+	physics::World world;
+	world.gravity = physics::Vec2(0, 9.81f);
+	world.iterations = 2;
+	world.bodies.reserve(32);
+	world.arbiters.reserve(64);
+
+	ecs::Registry registry;
+	Level level;
+	level.configure(WIDTH, HEIGHT, 0, 1, 2, 3);
+	level.reset(data, 1, 0);
+
+	physics::Body player;
+	player.fixedRotation = true;
+	// Same shape as the game's character
+	player.set(physics::Vec2(HEIGHT / 20.0f * 1.9f, 1.705882353f * HEIGHT / 20.0f * 1.9f), 0.01f, physics::SHAPE::CAPSULE);
+	player.friction = 2.0f;
+	player.position = level.getSpawn(player.width);
+	world.add(&player);
+
+	LevelResult result{ 0.0, 0.0, 0, 0, 0, 0, 0, 0xcbf29ce484222325ULL };
+	std::vector<double> stepMs;
+	stepMs.reserve(ticks);
+	int streamedPage = -1;
+	float maxCameraX = std::max(level.getWidth() - WIDTH, 0.0f);
+
+	for (int tick = 0; tick < ticks; ++tick) {
+		AllocationScope tickScope;
+
+		float cameraX = std::min(tick * PAN_SPEED, maxCameraX);
+		int page = static_cast<int>(cameraX / WIDTH);
+		bool streamed = false;
+		if (page != streamedPage) {
+			streamed = level.stream(world, registry, (page - 1) * static_cast<float>(WIDTH), (page + STATIC_LAYER_PAGES + 1) * static_cast<float>(WIDTH));
+			streamedPage = page;
+		}
+
+		// Keep the player busy in view: run, jump, and drop back in from the
+		// top once fallen out
+		if (player.position.y > HEIGHT + player.width.y || player.position.x < cameraX - player.width.x) {
+			player.position.set(cameraX + WIDTH / 2.0f, 0.0f);
+			player.velocity.set(0.0f, 0.0f);
+		}
+		player.velocity.x = 20.0f;
+		if (player.canJump && tick % 40 == 0) {
+			player.velocity.y = -40.0f;
+		}
+
+		auto start = clock::now();
+		world.step(TICK);
+		stepMs.push_back(std::chrono::duration<double, std::milli>(clock::now() - start).count());
+
+		for (const physics::Body* body : world.bodies) {
+			float state[6] = { body->position.x, body->position.y, body->velocity.x, body->velocity.y, body->rotation, body->angularVelocity };
+			hashState(result.hash, state, 6);
+		}
+
+		registry.each<PhysicsBody, MovingPlatform>([](PhysicsBody& physicsBody, MovingPlatform& platform) {
+			physics::Body* body = physicsBody.body;
+			if (body->position.y >= platform.maxY || body->position.y <= platform.minY) {
+				body->velocity.y = -body->velocity.y;
+			}
+		});
+		registry.each<Transform, PhysicsBody>([](Transform& transform, PhysicsBody& physicsBody) {
+			transform.position = physicsBody.body->position;
+		});
+
+		result.maxBodies = std::max(result.maxBodies, static_cast<int>(world.bodies.size()));
+		result.maxArbiters = std::max(result.maxArbiters, static_cast<int>(world.arbiters.size()));
+
+		uint64_t allocations = tickScope.allocations();
+		result.allocations += allocations;
+		// The first tick fills the reserved capacities
+		if (!streamed && tick > 0) {
+			++result.steadyTicks;
+			if (allocations) {
+				++result.allocatingTicks;
+			}
+		}
+	}
+
+	level.unload(world, registry);
+
+	double sum = 0.0;
+	for (double ms : stepMs) {
+		sum += ms;
+	}
+	result.stepMs = stepMs.empty() ? 0.0 : sum / stepMs.size();
+	result.stepP99Ms = percentile(stepMs, 0.99);
+	return result;
+}
+
+}
+
+int main(int argc, char** argv) {
+	int ticks = argc > 1 ? std::atoi(argv[1]) : DEFAULT_TICKS;
+	if (ticks <= 0) {
+		std::fprintf(stderr, "usage: %s [ticks per level]\n", argv[0]);
+		return 2;
+	}
+
+	std::vector<CompiledLevel> levels;
+	std::string error;
+	if (!compileLevels(assetPath("levels"), levels, error) || levels.empty()) {
+		std::fprintf(stderr, "Could not load levels: %s\n", error.empty() ? "none found" : error.c_str());
+		return 1;
+	}
+
+#ifdef JUNGLE_WAYS_DETERMINISTIC
+	std::printf("Deterministic math\n");
+#else
+	std::printf("Native math\n");
+#endif
+	std::printf("%-16s %10s %10s %8s %8s %8s %10s %8s %16s\n", "level", "step ms", "p99 ms", "bodies", "arbiters", "steady", "allocating", "allocs", "state hash");
+
+	bool failed = false;
+	for (const auto& compiled : levels) {
+		LevelData data;
+		if (!data.view(compiled.blob.data(), compiled.blob.size())) {
+			std::fprintf(stderr, "Level %s does not validate\n", compiled.name.c_str());
+			return 1;
+		}
+
+		LevelResult result = run(data, ticks);
+		std::printf("%-16s %10.4f %10.4f %8d %8d %8d %10d %8llu %016llx\n", compiled.name.c_str(), result.stepMs, result.stepP99Ms, result.maxBodies, result.maxArbiters,
+			result.steadyTicks, result.allocatingTicks, static_cast<unsigned long long>(result.allocations), static_cast<unsigned long long>(result.hash));
+
+		if (result.allocatingTicks) {
+			failed = true;
+		}
+	}
+
+	if (failed) {
+		std::fprintf(stderr, "Steady ticks allocated on the heap\n");
+		return 1;
+	}
+	return 0;
+}
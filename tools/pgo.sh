@@ -0,0 +1,44 @@
+#!/bin/sh
+# Profile-guided build: builds a plain Release baseline, an instrumented
+# build that runs pgotrain to collect profiles, then the optimized build
+# from those profiles, and prints pgotrain's step times before and after.
+#
+#   tools/pgo.sh [build root, default build-pgo]
+#
+# Record more training sessions with `main --record tools/training/<name>.rec`.
+set -e
+
+SOURCE_DIR=$(cd "$(dirname "$0")/.." && pwd)
+ROOT=${1:-"$SOURCE_DIR/build-pgo"}
+BASE="$ROOT/baseline"
+PGO="$ROOT/pgo"
+PROFILES="$PGO/profiles"
+JOBS=$(nproc 2>/dev/null || echo 4)
+
+build() {
+	cmake -S "$SOURCE_DIR" -B "$1" -DCMAKE_BUILD_TYPE=Release "$2" "-DPGO_DIR=$PROFILES" > /dev/null
+	cmake --build "$1" -j "$JOBS" --target main pgotrain
+}
+
+echo "== Baseline"
+build "$BASE" -DPGO=OFF
+"$BASE/pgotrain" > "$ROOT/baseline.txt"
+
+echo "== Instrumented training run"
+rm -rf "$PROFILES"
+build "$PGO" -DPGO=GENERATE
+"$PGO/pgotrain" > /dev/null
+if ls "$PROFILES"/*.profraw > /dev/null 2>&1; then
+	llvm-profdata merge -o "$PROFILES/merged.profdata" "$PROFILES"/*.profraw
+fi
+
+echo "== Optimized build"
+build "$PGO" -DPGO=USE
+"$PGO/pgotrain" > "$ROOT/pgo.txt"
+
+echo
+echo "Step times, baseline against PGO"
+awk 'NR == FNR { if (FNR > 1) { mean[$1] = $3; p99[$1] = $4 } next }
+	FNR == 1 { printf "%-24s %10s %10s %8s %10s %10s\n", "scene", "mean ms", "pgo ms", "speedup", "p99 ms", "pgo p99" ; next }
+	{ printf "%-24s %10.4f %10.4f %7.2fx %10.4f %10.4f\n", $1, mean[$1], $3, ($3 > 0 ? mean[$1] / $3 : 0), p99[$1], $4 }' \
+	"$ROOT/baseline.txt" "$ROOT/pgo.txt"